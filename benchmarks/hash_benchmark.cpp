@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include <flat_hash.hpp>
+#include <hash_utils.hpp>
+
+
+// Checks the hashes of utils for collisions on the key types the solutions use and compares
+// FlatHashSet with std::unordered_set on them. Fails if two different keys share a 64 bit hash.
+// Timings are only printed, they depend too much on the machine to be checked.
+
+namespace
+{
+    // Grid position as in days 21 and 23
+    struct Pos
+    {
+        int x;
+        int y;
+
+        bool operator==( Pos const& rhs ) const = default;
+    };
+
+    // Search node as in day 17
+    struct Node
+    {
+        int x;
+        int y;
+        int straightCount;
+        std::uint8_t dir;
+
+        bool operator==( Node const& rhs ) const = default;
+    };
+
+    // Stands in for the blocks of day 22, which are only hashed by address
+    struct Block
+    {
+        std::array< int, 6 > bounds;
+        bool isFalling;
+    };
+
+    constexpr auto REPETITIONS = 3;
+
+    std::vector< Pos > makePositions();
+
+    std::vector< Node > makeNodes();
+
+    std::vector< Block* > makeBlockPointers( std::vector< Block >& blocks );
+
+    // Fingerprints of distinct states as used by the cycle detection
+    std::vector< std::uint64_t > makeFingerprints();
+
+    // Fastest of a few runs in nanoseconds per key
+    template < typename TFunction >
+    double measure( std::size_t count, TFunction const& function );
+
+    // Prints the results for one key type and returns whether it had no 64 bit collisions
+    template < typename TKey >
+    bool runBenchmark( std::string_view name, std::vector< TKey > const& keys );
+}
+
+template <>
+struct std::hash< Pos >
+{
+    std::size_t operator()( Pos const& pos ) const noexcept
+    {
+        auto hasher = HashComputer{};
+        hasher.push( pos.x );
+        hasher.push( pos.y );
+        return hasher.getValue();
+    }
+};
+
+template <>
+struct std::hash< Node >
+{
+    std::size_t operator()( Node const& node ) const noexcept
+    {
+        auto hasher = HashComputer{};
+        hasher.push( node.x );
+        hasher.push( node.y );
+        hasher.push( node.straightCount );
+        hasher.push( node.dir );
+        return hasher.getValue();
+    }
+};
+
+
+int main()
+{
+    auto blocks = std::vector< Block >( 1500 );
+
+    auto success = true;
+    success &= runBenchmark( "Pos 1000x1000", makePositions() );
+    success &= runBenchmark( "Node 141x141x11x4", makeNodes() );
+    success &= runBenchmark( "Block* 1500", makeBlockPointers( blocks ) );
+    success &= runBenchmark( "fingerprint 1000000", makeFingerprints() );
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+namespace
+{
+    std::vector< Pos > makePositions()
+    {
+        auto positions = std::vector< Pos >{};
+        for( int y = 0; y < 1000; ++y )
+        {
+            for( int x = 0; x < 1000; ++x )
+            {
+                positions.push_back( { x, y } );
+            }
+        }
+        return positions;
+    }
+
+    std::vector< Node > makeNodes()
+    {
+        auto nodes = std::vector< Node >{};
+        for( int y = 0; y < 141; ++y )
+        {
+            for( int x = 0; x < 141; ++x )
+            {
+                for( int straightCount = 0; straightCount < 11; ++straightCount )
+                {
+                    for( std::uint8_t dir = 0; dir < 4; ++dir )
+                    {
+                        nodes.push_back( { x, y, straightCount, dir } );
+                    }
+                }
+            }
+        }
+        return nodes;
+    }
+
+    std::vector< Block* > makeBlockPointers( std::vector< Block >& blocks )
+    {
+        auto pointers = std::vector< Block* >{};
+        for( auto& block : blocks )
+        {
+            pointers.push_back( &block );
+        }
+        return pointers;
+    }
+
+    std::vector< std::uint64_t > makeFingerprints()
+    {
+        auto fingerprints = std::vector< std::uint64_t >{};
+        for( auto i = std::uint64_t{ 0 }; i < 1000000; ++i )
+        {
+            fingerprints.push_back( hashBytes( std::as_bytes( std::span{ &i, 1 } ) ) );
+        }
+        return fingerprints;
+    }
+
+    template < typename TFunction >
+    double measure( std::size_t count, TFunction const& function )
+    {
+        auto best = std::numeric_limits< double >::max();
+
+        for( int i = 0; i < REPETITIONS; ++i )
+        {
+            auto const start = std::chrono::steady_clock::now();
+            function();
+            auto const duration = std::chrono::steady_clock::now() - start;
+
+            best = std::min( best, std::chrono::duration< double, std::nano >{ duration }.count() );
+        }
+
+        return best / static_cast< double >( count );
+    }
+
+    template < typename TKey >
+    bool runBenchmark( std::string_view name, std::vector< TKey > const& keys )
+    {
+        auto hashes = std::vector< std::uint64_t >{};
+        auto const hashTime = measure( keys.size(),
+                                       [ & ]
+                                       {
+                                           hashes.clear();
+                                           for( auto const& key : keys )
+                                           {
+                                               hashes.push_back( std::hash< TKey >{}( key ) );
+                                           }
+                                       } );
+
+        std::ranges::sort( hashes );
+        auto const distinct = static_cast< std::size_t >(
+            std::distance( std::begin( hashes ), std::ranges::unique( hashes ).begin() ) );
+
+        // Spread over the low bits, which pick the bucket of std::unordered_set
+        auto lowBits = std::vector< std::uint64_t >{};
+        for( auto const hash : hashes )
+        {
+            lowBits.push_back( hash & 0xFFFFF );
+        }
+        std::ranges::sort( lowBits );
+        auto const distinctLow = static_cast< std::size_t >(
+            std::distance( std::begin( lowBits ), std::ranges::unique( lowBits ).begin() ) );
+
+        auto const findAll = [ & ]( auto const& set )
+        {
+            auto found = 0uz;
+            for( auto const& key : keys )
+            {
+                found += set.contains( key );
+            }
+            return found;
+        };
+
+        auto flatSet = FlatHashSet< TKey >{};
+        auto const flatInsertTime = measure( keys.size(),
+                                             [ & ]
+                                             {
+                                                 flatSet = {};
+                                                 for( auto const& key : keys )
+                                                 {
+                                                     flatSet.insert( key );
+                                                 }
+                                             } );
+
+        auto stdSet = std::unordered_set< TKey >{};
+        auto const stdInsertTime = measure( keys.size(),
+                                            [ & ]
+                                            {
+                                                stdSet = {};
+                                                for( auto const& key : keys )
+                                                {
+                                                    stdSet.insert( key );
+                                                }
+                                            } );
+
+        auto flatFound = 0uz;
+        auto const flatFindTime = measure( keys.size(),
+                                           [ & ]
+                                           {
+                                               flatFound = findAll( flatSet );
+                                           } );
+
+        auto stdFound = 0uz;
+        auto const stdFindTime = measure( keys.size(),
+                                          [ & ]
+                                          {
+                                              stdFound = findAll( stdSet );
+                                          } );
+
+        fmt::print( "{:<20} keys {:>8}  distinct {:>8}  distinct low 20 bits {:>8}  "
+                    "hash {:>5.1f} ns\n",
+                    name,
+                    keys.size(),
+                    distinct,
+                    distinctLow,
+                    hashTime );
+        fmt::print( "{:<20} insert flat {:>6.1f} ns  std {:>6.1f} ns  "
+                    "find flat {:>6.1f} ns  std {:>6.1f} ns\n",
+                    "",
+                    flatInsertTime,
+                    stdInsertTime,
+                    flatFindTime,
+                    stdFindTime );
+
+        if( distinct != keys.size() || flatFound != keys.size() || stdFound != keys.size() )
+        {
+            fmt::print( stderr, "{}: {} of {} hashes distinct\n", name, distinct, keys.size() );
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -3,14 +3,11 @@
 #include <fstream>
 #include <iostream>
 
-#include <utils.hpp>
+#include <fmt/core.h>
 
-namespace
-{
-    bool isDigit( char c );
+#include <omp.h>
 
-    int digitToNumber( char c );
-}
+#include <utils.hpp>
 
 
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
@@ -22,29 +19,39 @@ ExpectedResults Application::EXPECTED_RESULTS = {
 
 long Application::computeResult( std::istream& inputStream )
 {
-    auto sum = 0L;
-    auto line = std::string{};
-    while( std::getline( inputStream, line ) )
-    {
-        auto const firstDigit = std::find_if( std::begin( line ), std::end( line ), isDigit );
-        auto const lastDigit = std::find_if( std::rbegin( line ), std::rend( line ), isDigit );
-
-        sum += digitToNumber( *firstDigit ) * 10 + digitToNumber( *lastDigit );
-    }
-
-    return sum;
-}
+    auto const scanner = WordScanner{ getDigitWords() };
+    auto const text = readAll( inputStream );
+    auto const chunks = splitLineChunks( text, 4 * omp_get_max_threads() );
 
+    auto sum = 0L;
+    auto missing = 0L;
 
-namespace
-{
-    bool isDigit( char c )
+#pragma omp parallel for reduction( + : sum, missing )
+    for( std::size_t i = 0; i < chunks.size(); ++i )
     {
-        return std::isdigit( c );
+        for( auto const line : splitLines( chunks[ i ] ) )
+        {
+            if( line.empty() )
+            {
+                continue;
+            }
+
+            auto const [ firstDigit, lastDigit ] = scanner.findFirstAndLast( line );
+
+            if( !firstDigit || !lastDigit )
+            {
+                ++missing;
+                continue;
+            }
+
+            sum += firstDigit.value() * 10 + lastDigit.value();
+        }
     }
 
-    int digitToNumber( char c )
+    if( missing > 0 )
     {
-        return c - '0';
+        throw std::runtime_error( fmt::format( "{} lines without digits", missing ) );
     }
+
+    return sum;
 }
@@ -1,25 +1,13 @@
 #include <algorithm>
-#include <cctype>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
-#include <map>
-#include <ranges>
-#include <regex>
-#include <string>
 
-#include <utils.hpp>
+#include <fmt/core.h>
 
+#include <omp.h>
 
-namespace
-{
-    auto const DIGITS = std::map< std::string, int >{
-        { "zero", 0 }, { "one", 1 }, { "two", 2 },   { "three", 3 }, { "four", 4 },
-        { "five", 5 }, { "six", 6 }, { "seven", 7 }, { "eight", 8 }, { "nine", 9 },
-        { "0", 0 },    { "1", 1 },   { "2", 2 },     { "3", 3 },     { "4", 4 },
-        { "5", 5 },    { "6", 6 },   { "7", 7 },     { "8", 8 },     { "9", 9 },
-    };
-}
+#include <utils.hpp>
 
 
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
@@ -31,43 +19,38 @@ ExpectedResults Application::EXPECTED_RESULTS = {
 
 long Application::computeResult( std::istream& inputStream )
 {
+    auto const scanner = WordScanner{ getSpelledDigitWords() };
+    auto const text = readAll( inputStream );
+    auto const chunks = splitLineChunks( text, 4 * omp_get_max_threads() );
+
     auto sum = 0L;
-    auto line = std::string{};
-    while( std::getline( inputStream, line ) )
+    auto missing = 0L;
+
+#pragma omp parallel for reduction( + : sum, missing )
+    for( std::size_t i = 0; i < chunks.size(); ++i )
     {
-        auto const digitFound = [ &line ]( auto const& pair )
+        for( auto const line : splitLines( chunks[ i ] ) )
         {
-            return pair.first != std::end( line );
-        };
+            if( line.empty() )
+            {
+                continue;
+            }
 
-        auto const firstDigit =
-            std::ranges::min( DIGITS |
-                              std::views::transform(
-                                  [ &line ]( auto const& digitEntry )
-                                  {
-                                      return std::make_pair(
-                                          std::ranges::search( line, digitEntry.first ).begin(),
-                                          digitEntry.second );
-                                  } ) |
-                              std::views::filter( digitFound ) )
-                .second;
+            auto const [ firstDigit, lastDigit ] = scanner.findFirstAndLast( line );
 
-        auto const lastDigit =
-            std::ranges::max( DIGITS |
-                              std::views::transform(
-                                  [ &line ]( auto const& digitEntry )
-                                  {
-                                      return std::make_pair(
-                                          std::ranges::find_end( line, digitEntry.first ).begin(),
-                                          digitEntry.second );
-                                  } ) |
-                              std::views::filter( digitFound ) )
-                .second;
+            if( !firstDigit || !lastDigit )
+            {
+                ++missing;
+                continue;
+            }
 
-        std::cout << "Line: " << line << '\n';
-        std::cout << "Min max: " << firstDigit << " " << lastDigit << '\n';
+            sum += firstDigit.value() * 10 + lastDigit.value();
+        }
+    }
 
-        sum += firstDigit * 10 + lastDigit;
+    if( missing > 0 )
+    {
+        throw std::runtime_error( fmt::format( "{} lines without digits", missing ) );
     }
 
     return sum;
@@ -1,3 +1,4 @@
+#include <array>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fstream>
@@ -14,40 +15,21 @@ namespace
     constexpr auto MAX_GREEN = 13;
     constexpr auto MAX_BLUE = 14;
 
-    struct CubeDraw
+    // One column per game property. Individual draws are folded into the maxima while parsing.
+    struct Games
     {
-        int numRed;
-        int numGreen;
-        int numBlue;
+        std::vector< int > ids;
+        std::vector< int > maxRed;
+        std::vector< int > maxGreen;
+        std::vector< int > maxBlue;
 
-        bool isValid() const
+        std::size_t size() const
         {
-            return numRed <= MAX_RED && numGreen <= MAX_GREEN && numBlue <= MAX_BLUE;
+            return ids.size();
         }
     };
 
-    struct Game
-    {
-        int id;
-        std::vector< CubeDraw > draws;
-
-        bool isValid() const
-        {
-            for( auto const& draw : draws )
-            {
-                if( !draw.isValid() )
-                {
-                    return false;
-                }
-            }
-
-            return true;
-        }
-    };
-
-    std::vector< Game > parseInput( std::istream& inputStream );
-
-    bool isValidGame( Game const& game );
+    Games parseInput( std::istream& inputStream );
 }
 
 
@@ -62,13 +44,14 @@ long Application::computeResult( std::istream& inputStream )
 {
     auto const games = parseInput( inputStream );
 
-    auto sum = 0;
-    for( auto const& game : games )
+    auto sum = 0L;
+
+#pragma omp simd reduction( + : sum )
+    for( std::size_t i = 0; i < games.size(); ++i )
     {
-        if( game.isValid() )
-        {
-            sum += game.id;
-        }
+        auto const isValid = games.maxRed[ i ] <= MAX_RED && games.maxGreen[ i ] <= MAX_GREEN &&
+                             games.maxBlue[ i ] <= MAX_BLUE;
+        sum += isValid ? games.ids[ i ] : 0;
     }
 
     return sum;
@@ -77,60 +60,87 @@ long Application::computeResult( std::istream& inputStream )
 
 namespace
 {
-    std::vector< Game > parseInput( std::istream& inputStream )
+    Games parseInput( std::istream& inputStream )
     {
-        auto const gamePattern = std::regex{ R"(^Game (\d+): (.*)$)" };
-        auto const cubePattern = std::regex{ R"(^\s*(\d*)\s*(red|blue|green)\s*$)" };
-
-        auto games = std::vector< Game >{};
-
-        auto line = std::string{};
-        while( std::getline( inputStream, line ) )
+        auto games = Games{};
+
+        // State of the game that is currently parsed
+        auto num = 0;
+        auto hasNum = false;
+        auto hasGame = false;
+        auto id = 0;
+        auto red = 0;
+        auto green = 0;
+        auto blue = 0;
+
+        auto const finishGame = [ & ]()
         {
-            auto match = std::smatch{};
-            if( !std::regex_match( line, match, gamePattern ) )
+            if( hasGame )
             {
-                throw std::runtime_error{ fmt::format( "Line does not match regex: {}", line ) };
+                games.ids.push_back( id );
+                games.maxRed.push_back( red );
+                games.maxGreen.push_back( green );
+                games.maxBlue.push_back( blue );
             }
 
-            auto gameObj = Game{};
-            gameObj.id = std::stoi( match[ 1 ] );
-            auto const draws = split( match[ 2 ], ';' );
-            for( auto const& draw : draws )
+            num = id = red = green = blue = 0;
+            hasNum = hasGame = false;
+        };
+
+        auto buffer = std::array< char, 1 << 16 >{};
+
+        while( inputStream )
+        {
+            inputStream.read( buffer.data(), buffer.size() );
+            auto const count = static_cast< std::size_t >( inputStream.gcount() );
+
+            for( std::size_t i = 0; i < count; ++i )
             {
-                auto drawObj = CubeDraw{};
-                auto const cubes = split( draw, ',' );
-                for( auto cube : cubes )
+                auto const c = buffer[ i ];
+
+                if( c >= '0' && c <= '9' )
+                {
+                    num = num * 10 + ( c - '0' );
+                    hasNum = true;
+                }
+                else if( c == ':' )
                 {
-                    if( !std::regex_match( cube, match, cubePattern ) )
+                    id = num;
+                    num = 0;
+                    hasNum = false;
+                    hasGame = true;
+                }
+                else if( c == '\n' )
+                {
+                    finishGame();
+                }
+                else if( hasNum && hasGame && c != ' ' )
+                {
+                    // Only the first letter of the color follows a number
+                    switch( c )
                     {
-                        throw std::runtime_error(
-                            fmt::format( "Draw does not match pattern: {}", draw ) );
+                        case 'r':
+                            red = std::max( red, num );
+                            break;
+                        case 'g':
+                            green = std::max( green, num );
+                            break;
+                        case 'b':
+                            blue = std::max( blue, num );
+                            break;
+                        default:
+                            throw std::runtime_error(
+                                fmt::format( "Unknown color in game {}", id ) );
                     }
 
-                    auto const num = std::stoi( match[ 1 ] );
-                    auto const& type = match[ 2 ];
-
-                    if( type == "red" )
-                    {
-                        drawObj.numRed = num;
-                    }
-                    else if( type == "green" )
-                    {
-                        drawObj.numGreen = num;
-                    }
-                    else if( type == "blue" )
-                    {
-                        drawObj.numBlue = num;
-                    }
+                    num = 0;
+                    hasNum = false;
                 }
-
-                gameObj.draws.push_back( drawObj );
             }
-
-            games.push_back( gameObj );
         }
 
+        finishGame();
+
         return games;
     }
 }
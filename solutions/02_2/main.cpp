@@ -1,3 +1,4 @@
+#include <array>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fstream>
@@ -7,41 +8,24 @@
 
 #include <utils.hpp>
 
+
 namespace
 {
-    struct CubeDraw
+    // One column per game property. Individual draws are folded into the maxima while parsing.
+    struct Games
     {
-        int numRed;
-        int numGreen;
-        int numBlue;
-    };
+        std::vector< int > ids;
+        std::vector< int > maxRed;
+        std::vector< int > maxGreen;
+        std::vector< int > maxBlue;
 
-    struct Game
-    {
-        int id;
-        std::vector< CubeDraw > draws;
-
-        long getPower() const
+        std::size_t size() const
         {
-            auto maxRed = 0;
-            auto maxGreen = 0;
-            auto maxBlue = 0;
-            for( auto const& draw : draws )
-            {
-                maxRed = std::max( maxRed, draw.numRed );
-                maxGreen = std::max( maxGreen, draw.numGreen );
-                maxBlue = std::max( maxBlue, draw.numBlue );
-            }
-
-            return maxRed * maxGreen * maxBlue;
+            return ids.size();
         }
     };
 
-    std::vector< std::string > split( const std::string& s, char delim );
-
-    std::vector< Game > parseInput( std::istream& inputStream );
-
-    bool isValidGame( Game const& game );
+    Games parseInput( std::istream& inputStream );
 }
 
 
@@ -56,10 +40,12 @@ long Application::computeResult( std::istream& inputStream )
 {
     auto const games = parseInput( inputStream );
 
-    auto sum = 0;
-    for( auto const& game : games )
+    auto sum = 0L;
+
+#pragma omp simd reduction( + : sum )
+    for( std::size_t i = 0; i < games.size(); ++i )
     {
-        sum += game.getPower();
+        sum += static_cast< long >( games.maxRed[ i ] ) * games.maxGreen[ i ] * games.maxBlue[ i ];
     }
 
     return sum;
@@ -68,74 +54,87 @@ long Application::computeResult( std::istream& inputStream )
 
 namespace
 {
-    std::vector< std::string > split( const std::string& s, char delim )
+    Games parseInput( std::istream& inputStream )
     {
-        auto result = std::vector< std::string >{};
-        auto stream = std::stringstream{ s };
-
-        auto item = std::string{};
-        while( getline( stream, item, delim ) )
+        auto games = Games{};
+
+        // State of the game that is currently parsed
+        auto num = 0;
+        auto hasNum = false;
+        auto hasGame = false;
+        auto id = 0;
+        auto red = 0;
+        auto green = 0;
+        auto blue = 0;
+
+        auto const finishGame = [ & ]()
         {
-            result.push_back( item );
-        }
-
-        return result;
-    }
+            if( hasGame )
+            {
+                games.ids.push_back( id );
+                games.maxRed.push_back( red );
+                games.maxGreen.push_back( green );
+                games.maxBlue.push_back( blue );
+            }
 
-    std::vector< Game > parseInput( std::istream& inputStream )
-    {
-        auto const gamePattern = std::regex{ R"(^Game (\d+): (.*)$)" };
-        auto const cubePattern = std::regex{ R"(^\s*(\d*)\s*(red|blue|green)\s*$)" };
+            num = id = red = green = blue = 0;
+            hasNum = hasGame = false;
+        };
 
-        auto games = std::vector< Game >{};
+        auto buffer = std::array< char, 1 << 16 >{};
 
-        auto line = std::string{};
-        while( std::getline( inputStream, line ) )
+        while( inputStream )
         {
-            auto match = std::smatch{};
-            if( !std::regex_match( line, match, gamePattern ) )
-            {
-                throw std::runtime_error{ fmt::format( "Line does not match regex: {}", line ) };
-            }
+            inputStream.read( buffer.data(), buffer.size() );
+            auto const count = static_cast< std::size_t >( inputStream.gcount() );
 
-            auto gameObj = Game{};
-            gameObj.id = std::stoi( match[ 1 ] );
-            auto const draws = split( match[ 2 ], ';' );
-            for( auto const& draw : draws )
+            for( std::size_t i = 0; i < count; ++i )
             {
-                auto drawObj = CubeDraw{};
-                auto const cubes = split( draw, ',' );
-                for( auto cube : cubes )
+                auto const c = buffer[ i ];
+
+                if( c >= '0' && c <= '9' )
                 {
-                    if( !std::regex_match( cube, match, cubePattern ) )
+                    num = num * 10 + ( c - '0' );
+                    hasNum = true;
+                }
+                else if( c == ':' )
+                {
+                    id = num;
+                    num = 0;
+                    hasNum = false;
+                    hasGame = true;
+                }
+                else if( c == '\n' )
+                {
+                    finishGame();
+                }
+                else if( hasNum && hasGame && c != ' ' )
+                {
+                    // Only the first letter of the color follows a number
+                    switch( c )
                     {
-                        throw std::runtime_error(
-                            fmt::format( "Draw does not match pattern: {}", draw ) );
+                        case 'r':
+                            red = std::max( red, num );
+                            break;
+                        case 'g':
+                            green = std::max( green, num );
+                            break;
+                        case 'b':
+                            blue = std::max( blue, num );
+                            break;
+                        default:
+                            throw std::runtime_error(
+                                fmt::format( "Unknown color in game {}", id ) );
                     }
 
-                    auto const num = std::stoi( match[ 1 ] );
-                    auto const& type = match[ 2 ];
-
-                    if( type == "red" )
-                    {
-                        drawObj.numRed = num;
-                    }
-                    else if( type == "green" )
-                    {
-                        drawObj.numGreen = num;
-                    }
-                    else if( type == "blue" )
-                    {
-                        drawObj.numBlue = num;
-                    }
+                    num = 0;
+                    hasNum = false;
                 }
-
-                gameObj.draws.push_back( drawObj );
             }
-
-            games.push_back( gameObj );
         }
 
+        finishGame();
+
         return games;
     }
 }
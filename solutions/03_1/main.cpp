@@ -1,3 +1,5 @@
+#include <array>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
@@ -11,58 +13,69 @@
 
 namespace
 {
-    using LineCallback =
-        std::function< void( std::string const&, std::string const&, std::string const& ) >;
+    // Run of digits in columns [begin, end)
+    struct NumberRun
+    {
+        long value;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct Row
+    {
+        // Sorted by column
+        std::vector< NumberRun > numbers;
+
+        // Bit x is set if column x holds a symbol
+        std::vector< std::uint64_t > symbols;
+
+        // Columns of '*' symbols in ascending order
+        std::vector< std::size_t > gears;
+
+        void parse( std::string const& line );
+    };
+
+    using RowCallback = std::function< void( Row const&, Row const&, Row const& ) >;
 
-    void iterateLines( std::istream& inputStream, LineCallback const& callback );
+    // Calls the callback for every row together with its neighbors. Only three rows are kept in
+    // memory and their buffers are reused.
+    void iterateRows( std::istream& inputStream, RowCallback const& callback );
 
-    using SymbolCallback = std::function< void( int ) >;
+    // Symbols of the three rows spread by one column to each side
+    void dilateSymbols( Row const& prev,
+                        Row const& cur,
+                        Row const& next,
+                        std::vector< std::uint64_t >& dilated );
 
-    void iterateSymbols( std::string const& line, SymbolCallback const& callback );
+    bool hasAnyBit( std::vector< std::uint64_t > const& mask, std::size_t begin, std::size_t end );
 }
 
 
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 4351 },
+    { "input_example.txt", 4361 },
     { "input_final.txt", 557705 },
 };
 
 long Application::computeResult( std::istream& inputStream )
 {
     auto sum = 0L;
-
-    iterateLines( inputStream,
-                  [ & ]( auto const& prevLine, auto const& curLine, auto const& nextLine )
-                  {
-                      std::cout << "Checking line: " << curLine << '\n';
-                      iterateNumbers(
-                          curLine,
-                          [ & ]( auto num, auto pos, auto len )
-                          {
-                              auto isValid = false;
-
-                              auto const updateValidity = [ & ]( auto symbPos )
-                              {
-                                  if( symbPos >= pos - 1 && symbPos <= pos + len )
-                                  {
-                                      isValid = true;
-                                  }
-                              };
-
-                              iterateSymbols( prevLine, updateValidity );
-                              iterateSymbols( curLine, updateValidity );
-                              iterateSymbols( nextLine, updateValidity );
-
-                              if( isValid )
-                              {
-                                  std::cout << "Adding " << num << '\n';
-                                  sum += num;
-                              }
-                          },
-                          false );
-                  } );
+    auto dilated = std::vector< std::uint64_t >{};
+
+    iterateRows( inputStream,
+                 [ & ]( auto const& prev, auto const& cur, auto const& next )
+                 {
+                     dilateSymbols( prev, cur, next, dilated );
+
+                     for( auto const& number : cur.numbers )
+                     {
+                         if( hasAnyBit( dilated, number.begin, number.end ) )
+                         {
+                             sum += number.value;
+                         }
+                     }
+                 } );
 
     return sum;
 }
@@ -70,40 +83,136 @@ long Application::computeResult( std::istream& inputStream )
 
 namespace
 {
-    void iterateLines( std::istream& inputStream, LineCallback const& callback )
+    void Row::parse( std::string const& line )
     {
-        auto prevLine = std::string{};
-        auto curLine = std::string{};
-        auto nextLine = std::string{};
+        numbers.clear();
+        gears.clear();
+        symbols.assign( ( line.size() + 63 ) / 64, 0 );
+
+        auto run = NumberRun{ 0, 0, 0 };
+        auto inNumber = false;
 
-        auto line = std::string{};
-        while( std::getline( inputStream, line ) )
+        for( std::size_t x = 0; x < line.size(); ++x )
         {
-            prevLine = curLine;
-            curLine = nextLine;
-            nextLine = line;
+            auto const c = line[ x ];
+
+            if( c >= '0' && c <= '9' )
+            {
+                if( !inNumber )
+                {
+                    run = NumberRun{ 0, x, x };
+                    inNumber = true;
+                }
+
+                run.value = run.value * 10 + ( c - '0' );
+                run.end = x + 1;
+                continue;
+            }
 
-            if( !curLine.empty() )
+            if( inNumber )
             {
-                callback( prevLine, curLine, nextLine );
+                numbers.push_back( run );
+                inNumber = false;
+            }
+
+            if( c != '.' )
+            {
+                symbols[ x / 64 ] |= std::uint64_t{ 1 } << ( x % 64 );
+            }
+
+            if( c == '*' )
+            {
+                gears.push_back( x );
             }
         }
 
-        if( !curLine.empty() )
+        if( inNumber )
         {
-            callback( curLine, nextLine, "" );
+            numbers.push_back( run );
         }
     }
 
-    void iterateSymbols( std::string const& line, SymbolCallback const& callback )
+    void iterateRows( std::istream& inputStream, RowCallback const& callback )
     {
-        for( std::size_t i = 0; i < line.size(); ++i )
+        auto rows = std::array< Row, 3 >{};
+        auto const empty = Row{};
+
+        // Index of the row that becomes the next one
+        auto next = 0uz;
+        auto count = 0uz;
+
+        for( auto const& line : readLines( inputStream ) )
         {
-            auto const c = line[ i ];
-            if( !std::isdigit( c ) && c != '.' )
+            rows[ next ].parse( line );
+            ++count;
+
+            if( count >= 2 )
             {
-                callback( i );
+                auto const& cur = rows[ ( next + 2 ) % 3 ];
+                auto const& prev = count >= 3 ? rows[ ( next + 1 ) % 3 ] : empty;
+                callback( prev, cur, rows[ next ] );
             }
+
+            next = ( next + 1 ) % 3;
+        }
+
+        if( count >= 1 )
+        {
+            auto const& cur = rows[ ( next + 2 ) % 3 ];
+            auto const& prev = count >= 2 ? rows[ ( next + 1 ) % 3 ] : empty;
+            callback( prev, cur, empty );
         }
     }
+
+    void dilateSymbols( Row const& prev,
+                        Row const& cur,
+                        Row const& next,
+                        std::vector< std::uint64_t >& dilated )
+    {
+        auto const words =
+            std::max( { prev.symbols.size(), cur.symbols.size(), next.symbols.size() } );
+        dilated.assign( words, 0 );
+
+        for( auto const* row : { &prev, &cur, &next } )
+        {
+            for( std::size_t w = 0; w < row->symbols.size(); ++w )
+            {
+                dilated[ w ] |= row->symbols[ w ];
+            }
+        }
+
+        auto carry = std::uint64_t{ 0 };
+        for( std::size_t w = 0; w < words; ++w )
+        {
+            auto const mask = dilated[ w ];
+            auto const above = w + 1 < words ? dilated[ w + 1 ] : 0;
+
+            dilated[ w ] = mask | mask << 1 | mask >> 1 | carry | above << 63;
+            carry = mask >> 63;
+        }
+    }
+
+    bool hasAnyBit( std::vector< std::uint64_t > const& mask, std::size_t begin, std::size_t end )
+    {
+        for( auto x = begin; x < end; x = ( x / 64 + 1 ) * 64 )
+        {
+            auto const w = x / 64;
+            if( w >= mask.size() )
+            {
+                return false;
+            }
+
+            auto const bits = std::min( end - w * 64, 64uz );
+            auto const upper =
+                bits == 64 ? ~std::uint64_t{ 0 } : ( std::uint64_t{ 1 } << bits ) - 1;
+            auto const lower = ~( ( std::uint64_t{ 1 } << ( x % 64 ) ) - 1 );
+
+            if( mask[ w ] & upper & lower )
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
 }
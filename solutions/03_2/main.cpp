@@ -1,22 +1,45 @@
+#include <array>
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
 #include <iostream>
 #include <regex>
 
+#include <fmt/core.h>
+
 #include <utils.hpp>
 
 
 namespace
 {
-    using LineCallback =
-        std::function< void( std::string const&, std::string const&, std::string const& ) >;
+    // Run of digits in columns [begin, end)
+    struct NumberRun
+    {
+        long value;
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    struct Row
+    {
+        // Sorted by column
+        std::vector< NumberRun > numbers;
 
-    void iterateLines( std::istream& inputStream, LineCallback const& callback );
+        // Bit x is set if column x holds a symbol
+        std::vector< std::uint64_t > symbols;
 
-    using SymbolCallback = std::function< void( int ) >;
+        // Columns of '*' symbols in ascending order
+        std::vector< std::size_t > gears;
 
-    void iterateSymbols( std::string const& line, SymbolCallback const& callback );
+        void parse( std::string const& line );
+    };
+
+    using RowCallback = std::function< void( Row const&, Row const&, Row const& ) >;
+
+    // Calls the callback for every row together with its neighbors. Only three rows are kept in
+    // memory and their buffers are reused.
+    void iterateRows( std::istream& inputStream, RowCallback const& callback );
 }
 
 
@@ -31,39 +54,44 @@ long Application::computeResult( std::istream& inputStream )
 {
     auto sum = 0L;
 
-    iterateLines( inputStream,
-                  [ & ]( auto const& prevLine, auto const& curLine, auto const& nextLine )
-                  {
-                      iterateSymbols( curLine,
-                                      [ & ]( auto symPos )
-                                      {
-                                          auto numbers = std::vector< int >{};
-
-                                          auto const collectNumbers =
-                                              [ & ]( auto num, auto pos, auto len )
-                                          {
-                                              if( pos <= symPos + 1 && pos + len >= symPos )
-                                              {
-                                                  numbers.push_back( num );
-                                              }
-                                          };
-
-                                          iterateNumbers( prevLine, collectNumbers, false );
-                                          iterateNumbers( curLine, collectNumbers, false );
-                                          iterateNumbers( nextLine, collectNumbers, false );
-
-                                          if( numbers.size() == 2 )
-                                          {
-                                              auto product = 1;
-                                              for( auto const num : numbers )
-                                              {
-                                                  product *= num;
-                                              }
-
-                                              sum += product;
-                                          }
-                                      } );
-                  } );
+    iterateRows( inputStream,
+                 [ & ]( auto const& prev, auto const& cur, auto const& next )
+                 {
+                     // Gears are visited left to right, so the first number that can still touch
+                     // a gear only moves forward in each row
+                     auto firsts = std::array< std::size_t, 3 >{ 0, 0, 0 };
+                     auto const rows = std::array< Row const*, 3 >{ &prev, &cur, &next };
+
+                     for( auto const gear : cur.gears )
+                     {
+                         auto count = 0;
+                         auto product = 1L;
+
+                         for( std::size_t r = 0; r < 3; ++r )
+                         {
+                             auto const& numbers = rows[ r ]->numbers;
+                             auto& first = firsts[ r ];
+
+                             while( first < numbers.size() && numbers[ first ].end < gear )
+                             {
+                                 ++first;
+                             }
+
+                             for( auto i = first;
+                                  i < numbers.size() && numbers[ i ].begin <= gear + 1;
+                                  ++i )
+                             {
+                                 ++count;
+                                 product *= numbers[ i ].value;
+                             }
+                         }
+
+                         if( count == 2 )
+                         {
+                             sum += product;
+                         }
+                     }
+                 } );
 
     return sum;
 }
@@ -71,40 +99,84 @@ long Application::computeResult( std::istream& inputStream )
 
 namespace
 {
-    void iterateLines( std::istream& inputStream, LineCallback const& callback )
+    void Row::parse( std::string const& line )
     {
-        auto prevLine = std::string{};
-        auto curLine = std::string{};
-        auto nextLine = std::string{};
+        numbers.clear();
+        gears.clear();
+        symbols.assign( ( line.size() + 63 ) / 64, 0 );
+
+        auto run = NumberRun{ 0, 0, 0 };
+        auto inNumber = false;
 
-        auto line = std::string{};
-        while( std::getline( inputStream, line ) )
+        for( std::size_t x = 0; x < line.size(); ++x )
         {
-            prevLine = curLine;
-            curLine = nextLine;
-            nextLine = line;
+            auto const c = line[ x ];
+
+            if( c >= '0' && c <= '9' )
+            {
+                if( !inNumber )
+                {
+                    run = NumberRun{ 0, x, x };
+                    inNumber = true;
+                }
+
+                run.value = run.value * 10 + ( c - '0' );
+                run.end = x + 1;
+                continue;
+            }
+
+            if( inNumber )
+            {
+                numbers.push_back( run );
+                inNumber = false;
+            }
 
-            if( !curLine.empty() )
+            if( c != '.' )
             {
-                callback( prevLine, curLine, nextLine );
+                symbols[ x / 64 ] |= std::uint64_t{ 1 } << ( x % 64 );
+            }
+
+            if( c == '*' )
+            {
+                gears.push_back( x );
             }
         }
 
-        if( !curLine.empty() )
+        if( inNumber )
         {
-            callback( curLine, nextLine, "" );
+            numbers.push_back( run );
         }
     }
 
-    void iterateSymbols( std::string const& line, SymbolCallback const& callback )
+    void iterateRows( std::istream& inputStream, RowCallback const& callback )
     {
-        for( std::size_t i = 0; i < line.size(); ++i )
+        auto rows = std::array< Row, 3 >{};
+        auto const empty = Row{};
+
+        // Index of the row that becomes the next one
+        auto next = 0uz;
+        auto count = 0uz;
+
+        for( auto const& line : readLines( inputStream ) )
         {
-            auto const c = line[ i ];
-            if( c == '*' )
+            rows[ next ].parse( line );
+            ++count;
+
+            if( count >= 2 )
             {
-                callback( i );
+                auto const& cur = rows[ ( next + 2 ) % 3 ];
+                auto const& prev = count >= 3 ? rows[ ( next + 1 ) % 3 ] : empty;
+                callback( prev, cur, rows[ next ] );
             }
+
+            next = ( next + 1 ) % 3;
+        }
+
+        if( count >= 1 )
+        {
+            auto const& cur = rows[ ( next + 2 ) % 3 ];
+            auto const& prev = count >= 2 ? rows[ ( next + 1 ) % 3 ] : empty;
+            callback( prev, cur, empty );
         }
     }
 }
@@ -1,4 +1,7 @@
+#include <bitset>
+#include <charconv>
 #include <cstdlib>
+#include <exception>
 #include <fmt/core.h>
 #include <fstream>
 #include <functional>
@@ -11,25 +14,24 @@
 
 namespace
 {
+    // Card numbers have to be below this value
+    constexpr auto NUMBER_BITS = 128;
+
+    using NumberSet = std::bitset< NUMBER_BITS >;
+
     struct Card
     {
-        std::unordered_set< int > winningNumbers;
-        std::unordered_set< int > myNumbers;
+        NumberSet winningNumbers;
+        NumberSet myNumbers;
 
-        long getWorth() const
+        long getMatches() const
         {
-            auto numWinning = 0;
-            for( auto const num : myNumbers )
-            {
-                if( winningNumbers.contains( num ) )
-                {
-                    ++numWinning;
-                }
-            }
-            return numWinning == 0 ? 0 : ( 1L << ( numWinning - 1 ) );
+            return static_cast< long >( ( winningNumbers & myNumbers ).count() );
         }
     };
 
+    Card parseCard( std::string_view line );
+
     std::vector< Card > parseInput( std::istream& inputStream );
 }
 
@@ -46,10 +48,10 @@ long Application::computeResult( std::istream& inputStream )
     auto const cards = parseInput( inputStream );
 
     auto sum = 0L;
-
     for( auto const& card : cards )
     {
-        sum += card.getWorth();
+        auto const matches = card.getMatches();
+        sum += matches == 0 ? 0 : ( 1L << ( matches - 1 ) );
     }
 
     return sum;
@@ -58,53 +60,80 @@ long Application::computeResult( std::istream& inputStream )
 
 namespace
 {
-    std::vector< std::string > split( const std::string& s, char delim )
+    Card parseCard( std::string_view line )
     {
-        auto result = std::vector< std::string >{};
-        auto stream = std::stringstream{ s };
+        auto const colon = line.find( ':' );
+        auto const bar = line.find( '|' );
 
-        auto item = std::string{};
-        while( getline( stream, item, delim ) )
+        if( colon == std::string_view::npos || bar == std::string_view::npos || bar < colon )
         {
-            result.push_back( item );
+            throw std::runtime_error( fmt::format( "Line does not match: {}", line ) );
         }
 
-        return result;
+        auto const parseNumbers = [ & ]( std::string_view numbers )
+        {
+            auto set = NumberSet{};
+            auto const* pos = numbers.data();
+            auto const* const end = pos + numbers.size();
+
+            while( pos != end )
+            {
+                if( *pos == ' ' )
+                {
+                    ++pos;
+                    continue;
+                }
+
+                auto num = 0;
+                auto const [ next, error ] = std::from_chars( pos, end, num );
+                if( error != std::errc{} || num < 0 || num >= NUMBER_BITS )
+                {
+                    throw std::runtime_error( fmt::format( "Invalid number in line: {}", line ) );
+                }
+
+                set.set( num );
+                pos = next;
+            }
+
+            return set;
+        };
+
+        return Card{
+            parseNumbers( line.substr( colon + 1, bar - colon - 1 ) ),  // winningNumbers
+            parseNumbers( line.substr( bar + 1 ) ),                     // myNumbers
+        };
     }
 
     std::vector< Card > parseInput( std::istream& inputStream )
     {
-        auto cards = std::vector< Card >{};
-        auto const pattern = std::regex{ R"(^Card\s+\d+:(.*)\|(.*)$)" };
-        auto line = std::string{};
-        while( std::getline( inputStream, line ) )
+        auto lines = std::vector< std::string >{};
+        for( auto const& line : readLines( inputStream ) )
+        {
+            lines.push_back( line );
+        }
+
+        auto cards = std::vector< Card >( lines.size() );
+
+        // Exceptions must not leave the parallel region
+        auto error = std::exception_ptr{};
+
+#pragma omp parallel for
+        for( std::size_t i = 0; i < lines.size(); ++i )
         {
-            auto match = std::smatch{};
-            if( !std::regex_match( line, match, pattern ) )
+            try
             {
-                throw std::runtime_error( fmt::format( "Line does not match: {}", line ) );
+                cards[ i ] = parseCard( lines[ i ] );
             }
+            catch( ... )
+            {
+#pragma omp critical
+                error = std::current_exception();
+            }
+        }
 
-            std::cout << "Line: " << line << '\n';
-            auto card = Card{};
-            std::cout << "Match: " << match[ 0 ] << '\n';
-            std::cout << "Match: " << match[ 1 ] << '\n';
-            std::cout << "Match: " << match[ 2 ] << '\n';
-
-            iterateNumbers( match[ 1 ],
-                            [ &card ]( int num, int pos, int len )
-                            {
-                                std::cout << "Num: " << num << '\n';
-                                card.winningNumbers.insert( num );
-                            } );
-
-            iterateNumbers( match[ 2 ],
-                            [ &card ]( int num, int pos, int len )
-                            {
-                                card.myNumbers.insert( num );
-                            } );
-
-            cards.push_back( card );
+        if( error )
+        {
+            std::rethrow_exception( error );
         }
 
         return cards;
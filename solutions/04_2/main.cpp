@@ -1,4 +1,7 @@
+#include <bitset>
+#include <charconv>
 #include <cstdlib>
+#include <exception>
 #include <fmt/core.h>
 #include <fstream>
 #include <functional>
@@ -11,25 +14,24 @@
 
 namespace
 {
+    // Card numbers have to be below this value
+    constexpr auto NUMBER_BITS = 128;
+
+    using NumberSet = std::bitset< NUMBER_BITS >;
+
     struct Card
     {
-        std::unordered_set< int > winningNumbers;
-        std::unordered_set< int > myNumbers;
+        NumberSet winningNumbers;
+        NumberSet myNumbers;
 
-        long getWorth() const
+        long getMatches() const
         {
-            auto numWinning = 0;
-            for( auto const num : myNumbers )
-            {
-                if( winningNumbers.contains( num ) )
-                {
-                    ++numWinning;
-                }
-            }
-            return numWinning;
+            return static_cast< long >( ( winningNumbers & myNumbers ).count() );
         }
     };
 
+    Card parseCard( std::string_view line );
+
     std::vector< Card > parseInput( std::istream& inputStream );
 }
 
@@ -44,25 +46,22 @@ ExpectedResults Application::EXPECTED_RESULTS = {
 long Application::computeResult( std::istream& inputStream )
 {
     auto const cards = parseInput( inputStream );
-    auto cardAmount = std::vector< int >( cards.size(), 1 );
+
+    // Change of the number of copies from one card to the next. Each card adds its own copies to
+    // the range of cards it wins, so only the range boundaries are touched.
+    auto copyDiff = std::vector< long >( cards.size() + 1, 0 );
+    auto copies = 1L;
 
     auto sum = 0L;
 
     for( std::size_t i = 0; i < cards.size(); ++i )
     {
-        auto const& card = cards[ i ];
-        sum += cardAmount[ i ];
-
-        std::cout << "Amount: " << cardAmount[ i ] << '\n';
+        copies += copyDiff[ i ];
+        sum += copies;
 
-        auto const worth = card.getWorth();
-
-        std::cout << "Worth: " << worth << '\n';
-
-        for( std::size_t j = i + 1; j < i + 1 + worth; ++j )
-        {
-            cardAmount[ j ] += cardAmount[ i ];
-        }
+        auto const end = std::min( i + 1 + cards[ i ].getMatches(), cards.size() );
+        copyDiff[ i + 1 ] += copies;
+        copyDiff[ end ] -= copies;
     }
 
     return sum;
@@ -71,48 +70,80 @@ long Application::computeResult( std::istream& inputStream )
 
 namespace
 {
-    std::vector< std::string > split( const std::string& s, char delim )
+    Card parseCard( std::string_view line )
     {
-        auto result = std::vector< std::string >{};
-        auto stream = std::stringstream{ s };
+        auto const colon = line.find( ':' );
+        auto const bar = line.find( '|' );
 
-        auto item = std::string{};
-        while( getline( stream, item, delim ) )
+        if( colon == std::string_view::npos || bar == std::string_view::npos || bar < colon )
         {
-            result.push_back( item );
+            throw std::runtime_error( fmt::format( "Line does not match: {}", line ) );
         }
 
-        return result;
+        auto const parseNumbers = [ & ]( std::string_view numbers )
+        {
+            auto set = NumberSet{};
+            auto const* pos = numbers.data();
+            auto const* const end = pos + numbers.size();
+
+            while( pos != end )
+            {
+                if( *pos == ' ' )
+                {
+                    ++pos;
+                    continue;
+                }
+
+                auto num = 0;
+                auto const [ next, error ] = std::from_chars( pos, end, num );
+                if( error != std::errc{} || num < 0 || num >= NUMBER_BITS )
+                {
+                    throw std::runtime_error( fmt::format( "Invalid number in line: {}", line ) );
+                }
+
+                set.set( num );
+                pos = next;
+            }
+
+            return set;
+        };
+
+        return Card{
+            parseNumbers( line.substr( colon + 1, bar - colon - 1 ) ),  // winningNumbers
+            parseNumbers( line.substr( bar + 1 ) ),                     // myNumbers
+        };
     }
 
     std::vector< Card > parseInput( std::istream& inputStream )
     {
-        auto cards = std::vector< Card >{};
-        auto const pattern = std::regex{ R"(^Card\s+\d+:(.*)\|(.*)$)" };
-        auto line = std::string{};
-        while( std::getline( inputStream, line ) )
+        auto lines = std::vector< std::string >{};
+        for( auto const& line : readLines( inputStream ) )
         {
-            auto match = std::smatch{};
-            if( !std::regex_match( line, match, pattern ) )
-            {
-                throw std::runtime_error( fmt::format( "Line does not match: {}", line ) );
-            }
+            lines.push_back( line );
+        }
 
-            auto card = Card{};
+        auto cards = std::vector< Card >( lines.size() );
 
-            iterateNumbers( match[ 1 ],
-                            [ &card ]( int num, int pos, int len )
-                            {
-                                card.winningNumbers.insert( num );
-                            } );
+        // Exceptions must not leave the parallel region
+        auto error = std::exception_ptr{};
 
-            iterateNumbers( match[ 2 ],
-                            [ &card ]( int num, int pos, int len )
-                            {
-                                card.myNumbers.insert( num );
-                            } );
+#pragma omp parallel for
+        for( std::size_t i = 0; i < lines.size(); ++i )
+        {
+            try
+            {
+                cards[ i ] = parseCard( lines[ i ] );
+            }
+            catch( ... )
+            {
+#pragma omp critical
+                error = std::current_exception();
+            }
+        }
 
-            cards.push_back( card );
+        if( error )
+        {
+            std::rethrow_exception( error );
         }
 
         return cards;
@@ -1,3 +1,4 @@
+#include <charconv>
 #include <cmath>
 #include <cstdlib>
 #include <fmt/core.h>
@@ -7,58 +8,170 @@
 #include <regex>
 #include <unordered_set>
 
+#include <utils.hpp>
 
-#include <string_utils.hpp>
 
+namespace
+{
+    // Ignores the spaces between the digits of each line, turning all races into a single one
+    constexpr auto KERNED = true;
+
+    struct Races
+    {
+        std::vector< long > times;
+        std::vector< long > records;
+    };
+
+    Races parseRaces( std::istream& stream, bool kerned );
+
+    // Number of hold times h in [ 0, time ] with h * ( time - h ) > record
+    long countWins( long time, long record );
+
+    unsigned __int128 isqrt( unsigned __int128 value );
+}
+
+
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
-int main( int argc, char** argv )
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_example.txt", 71503 },
+    { "input_example_2.txt", 71503 },
+    { "input_final.txt", 46173809 },
+};
+
+long Application::computeResult( std::istream& inputStream )
 {
-    if( argc < 2 )
+    auto const races = parseRaces( inputStream, KERNED );
+
+    auto result = 1L;
+    for( std::size_t i = 0; i < races.times.size(); ++i )
     {
-        std::cerr << "Missing parameter: <input file>\n";
-        return EXIT_FAILURE;
+        auto const wins = countWins( races.times[ i ], races.records[ i ] );
+        if( __builtin_mul_overflow( result, wins, &result ) )
+        {
+            throw std::overflow_error( "Product of winning counts exceeds long" );
+        }
     }
 
-    auto const fileName = std::string{ argv[ 1 ] };
-    auto fileStream = std::ifstream{ fileName };
-
-    auto line = std::string{};
-    std::getline( fileStream, line );
-    auto times = std::vector< long >{};
-    iterateNumbers( line,
-                    [ &times ]( auto num, auto start, auto len )
-                    {
-                        times.push_back( num );
-                    } );
-
-    std::getline( fileStream, line );
-    auto records = std::vector< long >{};
-    iterateNumbers( line,
-                    [ &records ]( auto num, auto start, auto len )
-                    {
-                        records.push_back( num );
-                    } );
+    return result;
+}
 
-    auto result = 1L;
-    for( std::size_t i = 0; i < times.size(); ++i )
+namespace
+{
+    Races parseRaces( std::istream& stream, bool kerned )
+    {
+        auto const parseLine = [ kerned ]( std::string line )
+        {
+            auto const colon = line.find( ':' );
+            if( colon == std::string::npos )
+            {
+                throw std::runtime_error( fmt::format( "Invalid line: {}", line ) );
+            }
+            line.erase( 0, colon + 1 );
+
+            if( kerned )
+            {
+                std::erase( line, ' ' );
+            }
+
+            auto values = std::vector< long >{};
+            auto const* pos = line.data();
+            auto const* const end = pos + line.size();
+
+            while( pos != end )
+            {
+                if( *pos == ' ' )
+                {
+                    ++pos;
+                    continue;
+                }
+
+                auto value = 0L;
+                auto const [ next, error ] = std::from_chars( pos, end, value );
+                if( error != std::errc{} )
+                {
+                    throw std::runtime_error( fmt::format( "Invalid number in line: {}", line ) );
+                }
+
+                values.push_back( value );
+                pos = next;
+            }
+
+            return values;
+        };
+
+        auto line = std::string{};
+        auto races = Races{};
+
+        std::getline( stream, line );
+        races.times = parseLine( line );
+
+        std::getline( stream, line );
+        races.records = parseLine( line );
+
+        if( races.times.size() != races.records.size() )
+        {
+            throw std::runtime_error( "Number of times and records differ" );
+        }
+
+        return races;
+    }
+
+    long countWins( long time, long record )
     {
-        auto const time = times[ i ];
-        auto const record = records[ i ];
+        using Wide = unsigned __int128;
+
+        if( time < 0 || record < 0 )
+        {
+            throw std::invalid_argument( "Times and records must not be negative" );
+        }
+
+        auto const t = static_cast< Wide >( time );
+        auto const d = static_cast< Wide >( record );
+        auto const wins = [ & ]( Wide hold )
+        {
+            return hold * ( t - hold ) > d;
+        };
+
+        // The best hold time is time / 2, everything else is symmetric around it
+        if( !wins( t / 2 ) )
+        {
+            return 0;
+        }
 
-        auto const a1 =
-            static_cast< long >( time / 2.0 - std::sqrt( std::pow( time / 2.0, 2.0 ) - record ) );
-        auto const a2 = static_cast< long >(
-            std::ceil( time / 2.0 + std::sqrt( std::pow( time / 2.0, 2.0 ) - record ) ) );
+        // Smallest winning hold time is just above ( time - sqrt( time^2 - 4 * record ) ) / 2.
+        // The integer square root may be off by one in either direction of the real root.
+        auto const root = isqrt( t * t - 4 * d );
+        auto first = ( t - std::min( root, t ) ) / 2;
 
-        auto const numWins = a2 - a1 - 1;
+        while( first > 0 && wins( first - 1 ) )
+        {
+            --first;
+        }
 
-        std::cout << time << " " << record << '\n';
-        std::cout << numWins << '\n';
+        while( !wins( first ) )
+        {
+            ++first;
+        }
 
-        result *= numWins;
+        return static_cast< long >( t - 2 * first + 1 );
     }
 
-    std::cout << result << '\n';
+    unsigned __int128 isqrt( unsigned __int128 value )
+    {
+        auto const estimate = std::sqrt( static_cast< long double >( value ) );
+        auto root = static_cast< unsigned __int128 >( estimate );
+
+        while( root > 0 && root * root > value )
+        {
+            --root;
+        }
 
-    return EXIT_SUCCESS;
+        while( ( root + 1 ) * ( root + 1 ) <= value )
+        {
+            ++root;
+        }
+
+        return root;
+    }
 }
@@ -6,101 +6,241 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <map>
 #include <regex>
 #include <unordered_set>
 
-
-#include <stream_utils.hpp>
-#include <string_utils.hpp>
+#include <utils.hpp>
 
 
 namespace
 {
-    struct History
+    // Number of steps to extrapolate, positive values extend forward and negative ones backward
+    constexpr auto STEPS = -1L;
+
+    // Sequences of equal length stored column-wise, element i of sequence s is at
+    // values[ i * count + s ]
+    struct SequenceBatch
+    {
+        std::size_t length;
+        std::size_t count;
+        std::vector< long > values;
+    };
+
+    // Extrapolation of a sequence by repeated differences is polynomial extrapolation through all
+    // of its elements. The value k steps past the end of a sequence of length n is therefore
+    //   x[ n - 1 + k ] = sum_i w_i * x[ i ]
+    //   w_i = (-1)^( n - 1 - i ) * C( n - 1 + k, i ) * C( n - 2 + k - i, n - 1 - i )
+    // with one set of weights per length.
+    class Extrapolator
     {
     public:
-        std::vector< std::vector< long > > rows;
+        explicit Extrapolator( long steps );
+
+        std::vector< long > extrapolate( SequenceBatch const& batch );
+
+    private:
+        std::vector< __int128 > const& getWeights( std::size_t length );
+
+        long m_steps;
+        std::unordered_map< std::size_t, std::vector< __int128 > > m_weights;
+    };
 
-        History( std::vector< long > row )
+    __int128 binomial( __int128 n, __int128 k );
+
+    std::map< std::size_t, SequenceBatch > loadBatches( std::istream& stream );
+}
+
+
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
+
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_example.txt", 2 },
+    { "input_final.txt", 1019 },
+};
+
+long Application::computeResult( std::istream& inputStream )
+{
+    auto extrapolator = Extrapolator{ STEPS };
+
+    auto sum = 0L;
+    for( auto const& [ length, batch ] : loadBatches( inputStream ) )
+    {
+        for( auto const value : extrapolator.extrapolate( batch ) )
         {
-            rows.push_back( row );
-            while( !std::all_of( std::begin( row ),
-                                 std::end( row ),
-                                 []( auto v )
-                                 {
-                                     return v == 0;
-                                 } ) )
+            sum += value;
+        }
+    }
+
+    return sum;
+}
+
+namespace
+{
+    Extrapolator::Extrapolator( long steps ) : m_steps{ steps }
+    {
+        if( steps == 0 )
+        {
+            throw std::invalid_argument( "Extrapolation requires a non-zero number of steps" );
+        }
+    }
+
+    std::vector< long > Extrapolator::extrapolate( SequenceBatch const& batch )
+    {
+        auto const& weights = getWeights( batch.length );
+        auto results = std::vector< long >( batch.count, 0 );
+
+        auto maxValue = static_cast< __int128 >( 0 );
+        for( auto const value : batch.values )
+        {
+            maxValue = std::max( maxValue, static_cast< __int128 >( std::abs( value ) ) );
+        }
+
+        auto bound = static_cast< __int128 >( 0 );
+        auto fitsLong = true;
+        for( auto const weight : weights )
+        {
+            auto term = static_cast< __int128 >( 0 );
+            fitsLong = fitsLong && !__builtin_mul_overflow( weight < 0 ? -weight : weight,
+                                                            maxValue,
+                                                            &term ) &&
+                       !__builtin_add_overflow( bound, term, &bound );
+        }
+        fitsLong = fitsLong && bound <= std::numeric_limits< long >::max();
+
+        if( fitsLong )
+        {
+            // No intermediate result can overflow, so the lanes use plain 64-bit arithmetic and
+            // the inner loop vectorizes
+            for( std::size_t i = 0; i < batch.length; ++i )
             {
-                row = computeDiff( row );
-                fmt::print( "Pushing: {}\n", row );
-                rows.push_back( row );
+                auto const weight = static_cast< long >( weights[ i ] );
+                auto const* row = &batch.values[ i * batch.count ];
+
+#pragma omp simd
+                for( std::size_t s = 0; s < batch.count; ++s )
+                {
+                    results[ s ] += weight * row[ s ];
+                }
             }
+
+            return results;
         }
 
-        void extendByOne()
+        for( std::size_t s = 0; s < batch.count; ++s )
         {
-            rows.back().push_back( 0 );
-            for( std::size_t i = 0; i < rows.size() - 1; ++i )
+            auto sum = static_cast< __int128 >( 0 );
+            for( std::size_t i = 0; i < batch.length; ++i )
             {
-                auto const& nextRow = rows[ rows.size() - i - 1 ];
-                auto& row = rows[ rows.size() - i - 2 ];
+                auto const value = batch.values[ i * batch.count + s ];
+                auto term = static_cast< __int128 >( 0 );
+                if( __builtin_mul_overflow( weights[ i ], value, &term ) ||
+                    __builtin_add_overflow( sum, term, &sum ) )
+                {
+                    throw std::overflow_error( "Extrapolated value exceeds 128 bits" );
+                }
+            }
 
-                row.push_back( row.back() + nextRow.back() );
+            if( sum > std::numeric_limits< long >::max() ||
+                sum < std::numeric_limits< long >::min() )
+            {
+                throw std::overflow_error( "Extrapolated value exceeds long" );
             }
+
+            results[ s ] = static_cast< long >( sum );
         }
 
-    private:
-        static std::vector< long > computeDiff( std::vector< long > row )
+        return results;
+    }
+
+    std::vector< __int128 > const& Extrapolator::getWeights( std::size_t length )
+    {
+        auto const iter = m_weights.find( length );
+        if( iter != std::end( m_weights ) )
         {
-            auto diff = std::vector< long >{};
+            return iter->second;
+        }
+
+        auto const n = static_cast< __int128 >( length );
+        auto const k = static_cast< __int128 >( std::abs( m_steps ) );
 
-            for( std::size_t i = 1; i < row.size(); ++i )
+        auto weights = std::vector< __int128 >( length );
+        for( std::size_t i = 0; i < length; ++i )
+        {
+            auto const sign = ( length - 1 - i ) % 2 == 0 ? 1 : -1;
+            auto weight = static_cast< __int128 >( 0 );
+
+            if( __builtin_mul_overflow( binomial( n - 1 + k, i ),
+                                        binomial( n - 2 + k - i, n - 1 - i ),
+                                        &weight ) )
             {
-                diff.push_back( row[ i ] - row[ i - 1 ] );
+                throw std::overflow_error( "Extrapolation weight exceeds 128 bits" );
             }
 
-            return diff;
+            // Extrapolating backwards is extrapolating the reversed sequence forwards
+            auto const index = m_steps > 0 ? i : length - 1 - i;
+            weights[ index ] = sign * weight;
         }
-    };
-}
 
+        return m_weights.emplace( length, std::move( weights ) ).first->second;
+    }
 
-int main( int argc, char** argv )
-{
-    if( argc < 2 )
+    __int128 binomial( __int128 n, __int128 k )
     {
-        std::cerr << "Missing parameter: <input file>\n";
-        return EXIT_FAILURE;
-    }
+        auto result = static_cast< __int128 >( 1 );
 
-    auto const fileName = std::string{ argv[ 1 ] };
-    auto fileStream = std::ifstream{ fileName };
+        for( __int128 i = 0; i < k; ++i )
+        {
+            if( __builtin_mul_overflow( result, n - i, &result ) )
+            {
+                throw std::overflow_error( "Binomial coefficient exceeds 128 bits" );
+            }
+            result /= i + 1;
+        }
 
-    auto sum = 0L;
+        return result;
+    }
 
-    iterateLines( fileStream,
-                  [ & ]( auto const& line )
-                  {
-                      auto firstRow = std::vector< long >{};
-                      iterateNumbers( line,
-                                      [ & ]( auto num, auto start, auto end )
-                                      {
-                                          firstRow.push_back( num );
-                                      } );
+    std::map< std::size_t, SequenceBatch > loadBatches( std::istream& stream )
+    {
+        auto sequences = std::map< std::size_t, std::vector< std::vector< long > > >{};
 
-                      std::reverse( std::begin( firstRow ), std::end( firstRow ) );
+        for( auto const& line : readLines( stream ) )
+        {
+            auto sequence = std::vector< long >{};
+            iterateNumbers( line,
+                            [ & ]( auto num, auto start, auto len )
+                            {
+                                sequence.push_back( num );
+                            } );
+
+            if( !sequence.empty() )
+            {
+                sequences[ sequence.size() ].push_back( std::move( sequence ) );
+            }
+        }
 
-                      auto hist = History{ std::move( firstRow ) };
-                      hist.extendByOne();
+        auto batches = std::map< std::size_t, SequenceBatch >{};
 
-                      sum += hist.rows[ 0 ].back();
-                  } );
+        for( auto const& [ length, group ] : sequences )
+        {
+            auto batch = SequenceBatch{
+                length,                                       // length
+                group.size(),                                 // count
+                std::vector< long >( length * group.size() )  // values
+            };
 
-    std::cout << "Result: " << sum << '\n';
+            for( std::size_t s = 0; s < group.size(); ++s )
+            {
+                for( std::size_t i = 0; i < length; ++i )
+                {
+                    batch.values[ i * batch.count + s ] = group[ s ][ i ];
+                }
+            }
 
-    return EXIT_SUCCESS;
-}
+            batches.emplace( length, std::move( batch ) );
+        }
 
-namespace
-{
+        return batches;
+    }
 }
@@ -1,4 +1,7 @@
+#include <array>
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fmt/format.h>
@@ -9,218 +12,192 @@
 #include <regex>
 #include <unordered_set>
 
-
-#include <stream_utils.hpp>
-#include <string_utils.hpp>
+#include <utils.hpp>
 
 
 namespace
 {
-    struct Map
+    // Directions in counter-clockwise order. Opposite directions differ by two.
+    enum Dir : std::int8_t
     {
-        int width;
-        int height;
-        std::vector< std::string > rows;
+        RIGHT,
+        UP,
+        LEFT,
+        DOWN,
+    };
+
+    constexpr auto NO_DIR = std::int8_t{ -1 };
 
-        char getTile( int x, int y ) const
+    constexpr auto DX = std::array< int, 4 >{ 1, 0, -1, 0 };
+    constexpr auto DY = std::array< int, 4 >{ 0, -1, 0, 1 };
+
+    // Bitmask of the sides of a tile that are connected by its pipe
+    constexpr std::uint8_t getConnections( char tile )
+    {
+        switch( tile )
         {
-            return rows.at( y )[ x ];
+            case '|':
+                return 1 << UP | 1 << DOWN;
+            case '-':
+                return 1 << LEFT | 1 << RIGHT;
+            case 'L':
+                return 1 << UP | 1 << RIGHT;
+            case 'J':
+                return 1 << UP | 1 << LEFT;
+            case '7':
+                return 1 << DOWN | 1 << LEFT;
+            case 'F':
+                return 1 << DOWN | 1 << RIGHT;
+            default:
+                return 0;
         }
+    }
 
-        char getTileType( int x, int y ) const;
+    using TurnTable = std::array< std::array< std::int8_t, 4 >, 256 >;
 
-        std::pair< int, int > findStart() const;
+    // Outgoing direction for each tile and direction of movement when entering it
+    constexpr TurnTable makeTurnTable()
+    {
+        auto table = TurnTable{};
 
-        long computePathLen() const;
-    };
+        for( int tile = 0; tile < 256; ++tile )
+        {
+            auto const connections = getConnections( static_cast< char >( tile ) );
 
-    Map parseMap( std::istream& stream );
-}
+            for( int dir = 0; dir < 4; ++dir )
+            {
+                auto const entrySide = ( dir + 2 ) % 4;
+                auto const exits = connections & ~( 1 << entrySide );
 
+                table[ tile ][ dir ] = ( connections & ( 1 << entrySide ) ) && exits != 0
+                                           ? static_cast< std::int8_t >( std::countr_zero(
+                                                 static_cast< unsigned >( exits ) ) )
+                                           : NO_DIR;
+            }
+        }
 
-int main( int argc, char** argv )
-{
-    if( argc < 2 )
-    {
-        std::cerr << "Missing parameter: <input file>\n";
-        return EXIT_FAILURE;
+        return table;
     }
 
-    auto const fileName = std::string{ argv[ 1 ] };
-    auto fileStream = std::ifstream{ fileName };
+    constexpr auto TURN_TABLE = makeTurnTable();
 
-    auto const map = parseMap( fileStream );
+    struct Pos
+    {
+        std::int32_t x;
+        std::int32_t y;
+    };
 
-    auto const pathLen = map.computePathLen();
+    // Tiles of the loop in traversal order starting at S
+    struct Loop
+    {
+        std::vector< Pos > tiles;
+    };
 
-    fmt::print( "Pathlen: {}\n", ( pathLen + 1 ) / 2 );
+    // Replaces S by the pipe that connects it to its neighbors and returns its position
+    Pos resolveStart( Grid< char >& grid );
 
-    return EXIT_SUCCESS;
+    Loop traceLoop( Grid< char > const& grid, Pos start );
 }
 
-namespace
-{
-    Map parseMap( std::istream& stream )
-    {
-        auto rows = std::vector< std::string >{};
 
-        iterateLines( stream,
-                      [ & ]( auto const& line )
-                      {
-                          rows.push_back( line );
-                      } );
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
-        return { rows[ 0 ].length(), rows.size(), rows };
-    }
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_example.txt", 8 },
+    { "input_final.txt", 6968 },
+};
 
-    std::pair< int, int > Map::findStart() const
-    {
-        for( int y = 0; y < height; ++y )
-        {
-            for( int x = 0; x < width; ++x )
-            {
-                if( getTile( x, y ) == 'S' )
-                    return std::make_pair( x, y );
-            }
-        }
+long Application::computeResult( std::istream& inputStream )
+{
+    auto grid = readGrid( inputStream );
+    auto const start = resolveStart( grid );
+    auto const loop = traceLoop( grid, start );
 
-        throw std::runtime_error( "No start found" );
-    }
+    return static_cast< long >( loop.tiles.size() / 2 );
+}
 
-    long Map::computePathLen() const
+namespace
+{
+    Pos resolveStart( Grid< char >& grid )
     {
-        auto pathLen = 0L;
-        auto [ x, y ] = findStart();
-
-        auto lastDir = 0;
-        switch( getTileType( x, y ) )
+        for( auto const [ x, y, v ] : grid.getElements() )
         {
-            case '|':
-                --y;
-                lastDir = 2;
-                break;
-            case '-':
-                ++x;
-                lastDir = 0;
-                break;
-            case 'L':
-                ++x;
-                lastDir = 0;
-                break;
-            case 'J':
-                --y;
-                lastDir = 2;
-                break;
-            case '7':
-                ++y;
-                lastDir = 3;
-                break;
-            case 'F':
-                ++y;
-                lastDir = 3;
-                break;
-        }
-
-        do
-        {
-            fmt::print( "Current: {} {}\n", x, y );
-            auto const tileType = getTileType( x, y );
-
-            auto newDir = lastDir;
+            if( v != 'S' )
+            {
+                continue;
+            }
 
-            switch( tileType )
+            auto connections = 0;
+            for( int dir = 0; dir < 4; ++dir )
             {
-                case '|':
-                    newDir = lastDir == 1 ? 1 : 3;
-                    break;
-                case '-':
-                    newDir = lastDir == 0 ? 0 : 2;
-                    break;
-                case 'L':
-                    newDir = lastDir == 2 ? 1 : 0;
-                    break;
-                case 'J':
-                    newDir = lastDir == 3 ? 2 : 1;
-                    break;
-                case '7':
-                    newDir = lastDir == 0 ? 3 : 2;
-                    break;
-                case 'F':
-                    newDir = lastDir == 2 ? 3 : 0;
-                    break;
+                auto const nx = static_cast< std::size_t >( x + DX[ dir ] );
+                auto const ny = static_cast< std::size_t >( y + DY[ dir ] );
+
+                if( !grid.isInside( nx, ny ) )
+                {
+                    continue;
+                }
+
+                auto const neighbor = static_cast< unsigned char >( grid( nx, ny ) );
+                if( TURN_TABLE[ neighbor ][ dir ] != NO_DIR )
+                {
+                    connections |= 1 << dir;
+                }
             }
 
-            switch( newDir )
+            for( auto const tile : { '|', '-', 'L', 'J', '7', 'F' } )
             {
-                case 0:
-                    ++x;
-                    break;
-                case 1:
-                    --y;
-                    break;
-                case 2:
-                    --x;
-                    break;
-                case 3:
-                    ++y;
-                    break;
+                if( getConnections( tile ) == connections )
+                {
+                    grid( x, y ) = tile;
+                    return { static_cast< std::int32_t >( x ), static_cast< std::int32_t >( y ) };
+                }
             }
 
-            lastDir = newDir;
-            ++pathLen;
-        } while( getTile( x, y ) != 'S' );
+            throw std::runtime_error( "Start does not connect to exactly two pipes" );
+        }
 
-        return pathLen;
+        throw std::runtime_error( "No start found" );
     }
 
-    char Map::getTileType( int x, int y ) const
+    Loop traceLoop( Grid< char > const& grid, Pos start )
     {
-        auto const value = getTile( x, y );
+        auto const width = static_cast< std::int32_t >( grid.getWidth() );
+        auto const height = static_cast< std::int32_t >( grid.getHeight() );
+        auto const& tiles = grid.getValues();
+
+        auto loop = Loop{};
 
-        if( value == 'S' )
+        // Enter the start tile through one of its connections so that the table yields the other
+        auto const startTile = static_cast< unsigned char >( grid( start.x, start.y ) );
+        auto dir = std::int8_t{ 0 };
+        while( TURN_TABLE[ startTile ][ dir ] == NO_DIR )
         {
-            auto const top = y > 0 && ( getTile( x, y - 1 ) == '|' || getTile( x, y - 1 ) == '7' ||
-                                        getTile( x, y - 1 ) == 'F' );
-            auto const right =
-                x < width - 1 && ( getTile( x + 1, y ) == '-' || getTile( x + 1, y ) == '7' ||
-                                   getTile( x + 1, y ) == 'J' );
-            auto const left = x > 0 && ( getTile( x - 1, y ) == '-' || getTile( x - 1, y ) == '7' ||
-                                         getTile( x - 1, y ) == 'J' );
-            auto const bottom =
-                y < height - 1 && ( getTile( x, y + 1 ) == '|' || getTile( x, y + 1 ) == '7' ||
-                                    getTile( x, y + 1 ) == 'F' );
-
-            if( top && bottom )
-            {
-                return '|';
-            }
+            ++dir;
+        }
 
-            if( left && right )
-            {
-                return '-';
-            }
+        auto pos = start;
 
-            if( top && right )
-            {
-                return 'L';
-            }
+        do
+        {
+            auto const index = static_cast< std::size_t >( pos.x + pos.y * width );
+            loop.tiles.push_back( pos );
 
-            if( top && left )
+            dir = TURN_TABLE[ static_cast< unsigned char >( tiles[ index ] ) ][ dir ];
+            if( dir == NO_DIR )
             {
-                return 'J';
+                throw std::runtime_error( fmt::format( "Loop breaks at {} {}", pos.x, pos.y ) );
             }
 
-            if( bottom && left )
-            {
-                return '7';
-            }
+            pos.x += DX[ dir ];
+            pos.y += DY[ dir ];
 
-            if( bottom && right )
+            if( pos.x < 0 || pos.x >= width || pos.y < 0 || pos.y >= height )
             {
-                return 'F';
+                throw std::runtime_error( "Loop leaves the map" );
             }
-        }
+        } while( pos.x != start.x || pos.y != start.y );
 
-        return value;
+        return loop;
     }
 }
@@ -1,4 +1,7 @@
+#include <array>
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fmt/format.h>
@@ -9,300 +12,295 @@
 #include <regex>
 #include <unordered_set>
 
-
-#include <stream_utils.hpp>
-#include <string_utils.hpp>
+#include <utils.hpp>
 
 
 namespace
 {
-    struct Map
+    enum class InteriorMode
     {
-        int width;
-        int height;
-        std::vector< std::string > rows;
-        std::vector< bool > partOfLoop;
+        // Shoelace formula and Pick's theorem on the loop tiles, O(loop length)
+        SHOELACE,
+
+        // Row-wise parity of the crossed pipes on bitmasks, O(width * height / 64)
+        SCANLINE,
+    };
+
+    constexpr auto INTERIOR_MODE = InteriorMode::SHOELACE;
 
-        char getTile( int x, int y ) const
+    // Grids up to this many tiles, like the examples, are evaluated with both modes, which have to
+    // agree
+    constexpr auto CROSS_CHECK_MAX_TILES = 1000uz;
+
+    // Directions in counter-clockwise order. Opposite directions differ by two.
+    enum Dir : std::int8_t
+    {
+        RIGHT,
+        UP,
+        LEFT,
+        DOWN,
+    };
+
+    constexpr auto NO_DIR = std::int8_t{ -1 };
+
+    constexpr auto DX = std::array< int, 4 >{ 1, 0, -1, 0 };
+    constexpr auto DY = std::array< int, 4 >{ 0, -1, 0, 1 };
+
+    // Bitmask of the sides of a tile that are connected by its pipe
+    constexpr std::uint8_t getConnections( char tile )
+    {
+        switch( tile )
         {
-            return rows.at( y )[ x ];
+            case '|':
+                return 1 << UP | 1 << DOWN;
+            case '-':
+                return 1 << LEFT | 1 << RIGHT;
+            case 'L':
+                return 1 << UP | 1 << RIGHT;
+            case 'J':
+                return 1 << UP | 1 << LEFT;
+            case '7':
+                return 1 << DOWN | 1 << LEFT;
+            case 'F':
+                return 1 << DOWN | 1 << RIGHT;
+            default:
+                return 0;
         }
+    }
 
-        char getTileType( int x, int y ) const;
-
-        std::pair< int, int > findStart() const;
+    using TurnTable = std::array< std::array< std::int8_t, 4 >, 256 >;
 
-        void markLoop();
+    // Outgoing direction for each tile and direction of movement when entering it
+    constexpr TurnTable makeTurnTable()
+    {
+        auto table = TurnTable{};
 
-        long countInner() const;
+        for( int tile = 0; tile < 256; ++tile )
+        {
+            auto const connections = getConnections( static_cast< char >( tile ) );
 
-        void traverseTiles( std::function< void( int, int ) > const& callback );
+            for( int dir = 0; dir < 4; ++dir )
+            {
+                auto const entrySide = ( dir + 2 ) % 4;
+                auto const exits = connections & ~( 1 << entrySide );
 
-        void print() const;
-    };
+                table[ tile ][ dir ] = ( connections & ( 1 << entrySide ) ) && exits != 0
+                                           ? static_cast< std::int8_t >( std::countr_zero(
+                                                 static_cast< unsigned >( exits ) ) )
+                                           : NO_DIR;
+            }
+        }
 
-    Map parseMap( std::istream& stream );
-}
+        return table;
+    }
 
+    constexpr auto TURN_TABLE = makeTurnTable();
 
-int main( int argc, char** argv )
-{
-    if( argc < 2 )
+    struct Pos
     {
-        std::cerr << "Missing parameter: <input file>\n";
-        return EXIT_FAILURE;
-    }
+        std::int32_t x;
+        std::int32_t y;
+    };
 
-    auto const fileName = std::string{ argv[ 1 ] };
-    auto fileStream = std::ifstream{ fileName };
+    // Tiles of the loop in traversal order starting at S
+    struct Loop
+    {
+        std::vector< Pos > tiles;
+    };
 
-    auto map = parseMap( fileStream );
+    // Replaces S by the pipe that connects it to its neighbors and returns its position
+    Pos resolveStart( Grid< char >& grid );
 
-    map.markLoop();
-    map.print();
-    auto const inner = map.countInner();
+    Loop traceLoop( Grid< char > const& grid, Pos start );
 
-    fmt::print( "Solution: {}\n", inner );
+    long countInnerShoelace( Loop const& loop );
 
-    return EXIT_SUCCESS;
+    long countInnerScanline( Grid< char > const& grid, Loop const& loop );
 }
 
-namespace
-{
-    Map parseMap( std::istream& stream )
-    {
-        auto rows = std::vector< std::string >{};
 
-        iterateLines( stream,
-                      [ & ]( auto const& line )
-                      {
-                          rows.push_back( line );
-                      } );
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
-        return { rows[ 0 ].length(), rows.size(), rows };
-    }
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_example_1.txt", 4 },
+    { "input_example_2.txt", 8 },
+    { "input_example_3.txt", 10 },
+    { "input_final.txt", 413 },
+};
 
-    std::pair< int, int > Map::findStart() const
-    {
-        for( int y = 0; y < height; ++y )
-        {
-            for( int x = 0; x < width; ++x )
-            {
-                if( getTile( x, y ) == 'S' )
-                    return std::make_pair( x, y );
-            }
-        }
+long Application::computeResult( std::istream& inputStream )
+{
+    auto grid = readGrid( inputStream );
+    auto const start = resolveStart( grid );
+    auto const loop = traceLoop( grid, start );
 
-        throw std::runtime_error( "No start found" );
-    }
+    auto const inner = INTERIOR_MODE == InteriorMode::SHOELACE ? countInnerShoelace( loop )
+                                                               : countInnerScanline( grid, loop );
 
-    void Map::markLoop()
+    if( grid.getValues().size() <= CROSS_CHECK_MAX_TILES )
     {
-        partOfLoop.resize( width * height, false );
-        traverseTiles(
-            [ this ]( int x, int y )
-            {
-                partOfLoop[ x + y * width ] = true;
-            } );
+        auto const other = INTERIOR_MODE == InteriorMode::SHOELACE
+                               ? countInnerScanline( grid, loop )
+                               : countInnerShoelace( loop );
 
-        for( int y = 0; y < height; ++y )
+        if( inner != other )
         {
-            for( int x = 0; x < width; ++x )
-            {
-                if( !partOfLoop[ x + y * width ] )
-                {
-                    rows.at( y )[ x ] = '.';
-                }
-            }
+            throw std::runtime_error(
+                fmt::format( "Interior modes disagree: {} and {}", inner, other ) );
         }
     }
 
-    long Map::countInner() const
-    {
-        auto total = 0L;
+    return inner;
+}
 
-        for( int y = 0; y < height; ++y )
+namespace
+{
+    Pos resolveStart( Grid< char >& grid )
+    {
+        for( auto const [ x, y, v ] : grid.getElements() )
         {
-            auto rowTiles = 0;
-
-            auto inside = false;
+            if( v != 'S' )
+            {
+                continue;
+            }
 
-            for( int x = 0; x < width; ++x )
+            auto connections = 0;
+            for( int dir = 0; dir < 4; ++dir )
             {
-                auto const isLoop = partOfLoop[ x + y * width ];
+                auto const nx = static_cast< std::size_t >( x + DX[ dir ] );
+                auto const ny = static_cast< std::size_t >( y + DY[ dir ] );
 
-                fmt::print( "Tile: {} {} {} {}\n", x, y, inside, isLoop );
+                if( !grid.isInside( nx, ny ) )
+                {
+                    continue;
+                }
 
-                if( inside && !isLoop )
+                auto const neighbor = static_cast< unsigned char >( grid( nx, ny ) );
+                if( TURN_TABLE[ neighbor ][ dir ] != NO_DIR )
                 {
-                    fmt::print( "Tile: {} {}\n", x, y );
-                    ++total;
+                    connections |= 1 << dir;
                 }
+            }
 
-                if( isLoop )
+            for( auto const tile : { '|', '-', 'L', 'J', '7', 'F' } )
+            {
+                if( getConnections( tile ) == connections )
                 {
-                    auto const tile = getTileType( x, y );
-
-                    switch( tile )
-                    {
-                        case '|':
-                            inside = !inside;
-                            break;
-                        case '7':
-                            inside = !inside;
-                            break;
-                        case 'F':
-                            inside = !inside;
-                            break;
-                    }
+                    grid( x, y ) = tile;
+                    return { static_cast< std::int32_t >( x ), static_cast< std::int32_t >( y ) };
                 }
             }
+
+            throw std::runtime_error( "Start does not connect to exactly two pipes" );
         }
 
-        return total;
+        throw std::runtime_error( "No start found" );
     }
 
-    void Map::traverseTiles( std::function< void( int, int ) > const& callback )
+    Loop traceLoop( Grid< char > const& grid, Pos start )
     {
-        auto [ x, y ] = findStart();
+        auto const width = static_cast< std::int32_t >( grid.getWidth() );
+        auto const height = static_cast< std::int32_t >( grid.getHeight() );
+        auto const& tiles = grid.getValues();
+
+        auto loop = Loop{};
 
-        auto lastDir = 0;
-        switch( getTileType( x, y ) )
+        // Enter the start tile through one of its connections so that the table yields the other
+        auto const startTile = static_cast< unsigned char >( grid( start.x, start.y ) );
+        auto dir = std::int8_t{ 0 };
+        while( TURN_TABLE[ startTile ][ dir ] == NO_DIR )
         {
-            case '|':
-                --y;
-                lastDir = 2;
-                break;
-            case '-':
-                ++x;
-                lastDir = 0;
-                break;
-            case 'L':
-                ++x;
-                lastDir = 0;
-                break;
-            case 'J':
-                --y;
-                lastDir = 2;
-                break;
-            case '7':
-                ++y;
-                lastDir = 3;
-                break;
-            case 'F':
-                ++y;
-                lastDir = 3;
-                break;
+            ++dir;
         }
 
-        callback( x, y );
+        auto pos = start;
 
         do
         {
-            auto const tileType = getTileType( x, y );
-
-            auto newDir = lastDir;
+            auto const index = static_cast< std::size_t >( pos.x + pos.y * width );
+            loop.tiles.push_back( pos );
 
-            switch( tileType )
+            dir = TURN_TABLE[ static_cast< unsigned char >( tiles[ index ] ) ][ dir ];
+            if( dir == NO_DIR )
             {
-                case '|':
-                    newDir = lastDir == 1 ? 1 : 3;
-                    break;
-                case '-':
-                    newDir = lastDir == 0 ? 0 : 2;
-                    break;
-                case 'L':
-                    newDir = lastDir == 2 ? 1 : 0;
-                    break;
-                case 'J':
-                    newDir = lastDir == 3 ? 2 : 1;
-                    break;
-                case '7':
-                    newDir = lastDir == 0 ? 3 : 2;
-                    break;
-                case 'F':
-                    newDir = lastDir == 2 ? 3 : 0;
-                    break;
+                throw std::runtime_error( fmt::format( "Loop breaks at {} {}", pos.x, pos.y ) );
             }
 
-            switch( newDir )
+            pos.x += DX[ dir ];
+            pos.y += DY[ dir ];
+
+            if( pos.x < 0 || pos.x >= width || pos.y < 0 || pos.y >= height )
             {
-                case 0:
-                    ++x;
-                    break;
-                case 1:
-                    --y;
-                    break;
-                case 2:
-                    --x;
-                    break;
-                case 3:
-                    ++y;
-                    break;
+                throw std::runtime_error( "Loop leaves the map" );
             }
+        } while( pos.x != start.x || pos.y != start.y );
 
-            lastDir = newDir;
-
-            callback( x, y );
-        } while( getTile( x, y ) != 'S' );
+        return loop;
     }
 
-    char Map::getTileType( int x, int y ) const
+    long countInnerShoelace( Loop const& loop )
     {
-        auto const value = getTile( x, y );
+        auto const& tiles = loop.tiles;
+        auto area = 0L;
 
-        if( value == 'S' )
+        for( std::size_t i = 0; i < tiles.size(); ++i )
         {
-            auto const top = y > 0 && ( getTile( x, y - 1 ) == '|' || getTile( x, y - 1 ) == '7' ||
-                                        getTile( x, y - 1 ) == 'F' );
-            auto const right =
-                x < width - 1 && ( getTile( x + 1, y ) == '-' || getTile( x + 1, y ) == '7' ||
-                                   getTile( x + 1, y ) == 'J' );
-            auto const left = x > 0 && ( getTile( x - 1, y ) == '-' || getTile( x - 1, y ) == 'L' ||
-                                         getTile( x - 1, y ) == 'F' );
-            auto const bottom =
-                y < height - 1 && ( getTile( x, y + 1 ) == '|' || getTile( x, y + 1 ) == 'L' ||
-                                    getTile( x, y + 1 ) == 'J' );
-
-            if( top && bottom )
-            {
-                return '|';
-            }
+            auto const& current = tiles[ i ];
+            auto const& next = tiles[ ( i + 1 ) % tiles.size() ];
+            area += static_cast< long >( current.x ) * next.y -
+                    static_cast< long >( next.x ) * current.y;
+        }
 
-            if( left && right )
-            {
-                return '-';
-            }
+        // Pick's theorem with the loop tiles as boundary points
+        auto const boundary = static_cast< long >( tiles.size() );
+        return std::abs( area ) / 2 - boundary / 2 + 1;
+    }
 
-            if( top && right )
-            {
-                return 'L';
-            }
+    long countInnerScanline( Grid< char > const& grid, Loop const& loop )
+    {
+        auto const wordsPerRow = ( grid.getWidth() + 63 ) / 64;
 
-            if( top && left )
-            {
-                return 'J';
-            }
+        // Row-aligned masks of the loop tiles and of the tiles whose pipe leaves downwards, which
+        // toggle between outside and inside
+        auto loopRows = std::vector< std::uint64_t >( wordsPerRow * grid.getHeight(), 0 );
+        auto toggleRows = std::vector< std::uint64_t >( wordsPerRow * grid.getHeight(), 0 );
 
-            if( bottom && left )
-            {
-                return '7';
-            }
+        for( auto const& pos : loop.tiles )
+        {
+            auto const word = pos.y * wordsPerRow + pos.x / 64;
+            auto const bit = std::uint64_t{ 1 } << ( pos.x % 64 );
 
-            if( bottom && right )
+            loopRows[ word ] |= bit;
+            if( getConnections( grid( pos.x, pos.y ) ) & ( 1 << DOWN ) )
             {
-                return 'F';
+                toggleRows[ word ] |= bit;
             }
         }
 
-        return value;
-    }
+        auto total = 0L;
 
-    void Map::print() const
-    {
-        for( int y = 0; y < height; ++y )
+        for( std::size_t y = 0; y < grid.getHeight(); ++y )
         {
-            fmt::print( "{}\n", rows[ y ] );
+            auto inside = std::uint64_t{ 0 };
+
+            for( std::size_t w = y * wordsPerRow; w < ( y + 1 ) * wordsPerRow; ++w )
+            {
+                // Prefix XOR turns the toggles into the parity after each position
+                auto parity = toggleRows[ w ];
+                parity ^= parity << 1;
+                parity ^= parity << 2;
+                parity ^= parity << 4;
+                parity ^= parity << 8;
+                parity ^= parity << 16;
+                parity ^= parity << 32;
+                parity ^= inside;
+
+                total += std::popcount( parity & ~loopRows[ w ] );
+
+                inside = ( parity >> 63 ) ? ~std::uint64_t{ 0 } : 0;
+            }
         }
+
+        return total;
     }
 }
@@ -1,3 +1,4 @@
+#include <array>
 #include <cmath>
 #include <cstdlib>
 #include <fmt/core.h>
@@ -8,148 +9,137 @@
 #include <iostream>
 #include <regex>
 #include <set>
+#include <span>
 #include <unordered_set>
 
-
-#include <stream_utils.hpp>
-#include <string_utils.hpp>
+#include <utils.hpp>
 
 
 namespace
 {
-    struct Galaxy
-    {
-        long x;
-        long y;
-    };
+    // Every empty row and column is replaced by this many unless the first argument says otherwise
+    constexpr auto EXPANSION_FACTOR = 1000000L;
 
+    // Number of galaxies per column and per row
     struct Map
     {
-        std::set< long > emptyRows;
-        std::set< long > emptyCols;
-        std::vector< Galaxy > galaxies;
-
-        long computeDistance( Galaxy const& lhs, Galaxy const& rhs ) const;
+        std::vector< long > colCounts;
+        std::vector< long > rowCounts;
 
         static Map parse( std::istream& stream );
     };
-}
-
 
-int main( int argc, char** argv )
-{
-    if( argc < 2 )
+    // Sum of the distances between all pairs of galaxies along one axis, split into the distance
+    // in the original map and the number of empty lines crossed. The expanded distance for a
+    // factor f is base + ( f - 1 ) * empty.
+    struct AxisSums
     {
-        std::cerr << "Missing parameter: <input file>\n";
-        return EXIT_FAILURE;
-    }
+        __int128 base;
+        __int128 empty;
+    };
 
-    auto const fileName = std::string{ argv[ 1 ] };
-    auto fileStream = std::ifstream{ fileName };
+    AxisSums computeAxisSums( std::vector< long > const& counts );
 
-    auto const map = Map::parse( fileStream );
+    std::vector< long > computeDistanceSums( Map const& map, std::span< long const > factors );
+}
 
-    auto sum = 0L;
-    for( auto i = 0; i < map.galaxies.size(); ++i )
-    {
-        for( auto j = i + 1; j < map.galaxies.size(); ++j )
-        {
-            sum += map.computeDistance( map.galaxies[ i ], map.galaxies[ j ] );
-        }
-    }
 
-    fmt::print( "Solution: {}\n", sum );
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
+
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_example_1.txt", 82000210 },
+    { "input_example_1.txt 2", 374 },
+    { "input_example_1.txt 10", 1030 },
+    { "input_example_1.txt 100", 8410 },
+    { "input_final.txt", 598693078798 },
+};
+
+long Application::computeResult( std::istream& inputStream )
+{
+    auto const map = Map::parse( inputStream );
+
+    auto const factor = getArgument( 0, EXPANSION_FACTOR );
 
-    return EXIT_SUCCESS;
+    return computeDistanceSums( map, std::array{ factor } ).front();
 }
 
 namespace
 {
     Map Map::parse( std::istream& stream )
     {
-        auto rows = std::vector< std::string >{};
-        iterateLines( stream,
-                      [ & ]( auto const& line )
-                      {
-                          rows.push_back( line );
-                      } );
-
-        auto const width = rows[ 0 ].size();
-        auto const height = rows.size();
-
-        auto galaxies = std::vector< Galaxy >{};
-        for( auto y = 0; y < height; ++y )
-        {
-            for( auto x = 0; x < width; ++x )
-            {
-                if( rows[ y ][ x ] == '#' )
-                {
-                    galaxies.push_back( Galaxy{ x, y } );
-                }
-            }
-        }
+        auto map = Map{};
 
-        auto emptyRows = std::set< long >{};
-        for( auto y = 0; y < height; ++y )
+        for( auto const& line : readLines( stream ) )
         {
-            auto empty = true;
-            for( auto x = 0; x < width; ++x )
-            {
-                if( rows[ y ][ x ] != '.' )
-                {
-                    empty = false;
-                    break;
-                }
-            }
-            if( empty )
-            {
-                emptyRows.insert( y );
-            }
-        }
+            map.colCounts.resize( std::max( map.colCounts.size(), line.size() ), 0 );
+            auto& rowCount = map.rowCounts.emplace_back( 0 );
 
-        auto emptyCols = std::set< long >{};
-        for( auto x = 0; x < width; ++x )
-        {
-            auto empty = true;
-            for( auto y = 0; y < height; ++y )
+            for( std::size_t x = 0; x < line.size(); ++x )
             {
-                if( rows[ y ][ x ] != '.' )
+                if( line[ x ] == '#' )
                 {
-                    empty = false;
-                    break;
+                    ++map.colCounts[ x ];
+                    ++rowCount;
                 }
             }
-            if( empty )
-            {
-                emptyCols.insert( x );
-            }
         }
 
-        return Map{ std::move( emptyRows ), std::move( emptyCols ), std::move( galaxies ) };
+        return map;
     }
 
-    long Map::computeDistance( Galaxy const& lhs, Galaxy const& rhs ) const
+    AxisSums computeAxisSums( std::vector< long > const& counts )
     {
-        auto dist = 0L;
+        auto sums = AxisSums{ 0, 0 };
+
+        // Number of galaxies, sum of their coordinates and sum of their empty lines before the
+        // current coordinate
+        auto prevCount = static_cast< __int128 >( 0 );
+        auto prevCoords = static_cast< __int128 >( 0 );
+        auto prevEmpty = static_cast< __int128 >( 0 );
 
-        for( auto x = std::min( lhs.x, rhs.x ); x < std::max( lhs.x, rhs.x ); ++x )
+        auto empty = 0L;
+
+        for( std::size_t coord = 0; coord < counts.size(); ++coord )
         {
-            ++dist;
-            if( emptyCols.contains( x ) )
+            auto const count = counts[ coord ];
+
+            if( count == 0 )
             {
-                dist += 999999;
+                ++empty;
+                continue;
             }
+
+            sums.base += count * ( prevCount * static_cast< long >( coord ) - prevCoords );
+            sums.empty += count * ( prevCount * empty - prevEmpty );
+
+            prevCount += count;
+            prevCoords += static_cast< __int128 >( count ) * static_cast< long >( coord );
+            prevEmpty += static_cast< __int128 >( count ) * empty;
         }
 
-        for( auto y = std::min( lhs.y, rhs.y ); y < std::max( lhs.y, rhs.y ); ++y )
+        return sums;
+    }
+
+    std::vector< long > computeDistanceSums( Map const& map, std::span< long const > factors )
+    {
+        auto const cols = computeAxisSums( map.colCounts );
+        auto const rows = computeAxisSums( map.rowCounts );
+
+        auto results = std::vector< long >{};
+
+        for( auto const factor : factors )
         {
-            ++dist;
-            if( emptyRows.contains( y ) )
+            auto const sum = cols.base + rows.base + ( factor - 1 ) * ( cols.empty + rows.empty );
+
+            if( sum > std::numeric_limits< long >::max() )
             {
-                dist += 999999;
+                throw std::overflow_error(
+                    fmt::format( "Distance sum for expansion {} exceeds long", factor ) );
             }
+
+            results.push_back( static_cast< long >( sum ) );
         }
 
-        return dist;
+        return results;
     }
 }
@@ -1,10 +1,12 @@
+#include <bit>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 #include <fstream>
-#include <functional>
 #include <iostream>
 #include <numeric>
 #include <regex>
@@ -18,195 +20,159 @@
 
 namespace
 {
+    // Number of cells that differ between the two halves of a reflection
+    constexpr auto SMUDGES = 1;
+
+    // Rows and columns of a pattern encoded as bitmasks with bit i set for a '#' at position i
     struct Pattern
     {
-        std::size_t width;
-        std::size_t height;
-        std::vector< std::string > rows;
-        std::vector< std::string > cols;
-
-        std::optional< std::size_t > findMirrorRow() const;
-
-        std::optional< std::size_t > findMirrorCol() const;
+        std::vector< std::uint64_t > rows;
+        std::vector< std::uint64_t > cols;
 
-        void flipPoint( std::size_t x, std::size_t y );
-
-        Pattern( std::vector< std::string > rowValues );
+        Pattern( std::vector< std::string > const& lines );
     };
 
-    std::vector< std::size_t > getMirrorPoints( std::string const& row );
+    // Number of lines before the reflection whose mirrored line pairs differ in exactly
+    // `smudges` cells
+    std::optional< std::size_t > findMirror( std::vector< std::uint64_t > const& lines,
+                                             int smudges );
 
-    std::optional< std::size_t > findMirror( std::vector< std::string > const& rows,
-                                             std::optional< std::size_t > exclude = {} );
+    long summarize( Pattern const& pattern, int smudges );
 
-    void iteratePatterns( std::istream& stream,
-                          std::function< void( Pattern const& ) > const& callback );
+    std::vector< Pattern > readPatterns( std::istream& stream );
 }
 
 
-int main( int argc, char** argv )
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
+
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_example_1.txt", 400 },
+    { "input_final.txt", 38063 },
+};
+
+long Application::computeResult( std::istream& inputStream )
 {
-    if( argc < 2 )
+    auto const patterns = readPatterns( inputStream );
+
+    auto sum = 0L;
+
+    // Exceptions must not leave the parallel loop
+    auto error = std::exception_ptr{};
+
+#pragma omp parallel for reduction( + : sum ) shared( error )
+    for( std::size_t i = 0; i < patterns.size(); ++i )
     {
-        std::cerr << "Missing parameter: <input file>\n";
-        return EXIT_FAILURE;
+        try
+        {
+            sum += summarize( patterns[ i ], SMUDGES );
+        }
+        catch( ... )
+        {
+#pragma omp critical
+            error = std::current_exception();
+        }
     }
 
-    auto const fileName = std::string{ argv[ 1 ] };
-    auto fileStream = std::ifstream{ fileName };
+    if( error )
+    {
+        std::rethrow_exception( error );
+    }
 
-    auto sum = 0L;
-    iteratePatterns( fileStream,
-                     [ & ]( auto pattern )
-                     {
-                         auto const oRowMirror = findMirror( pattern.rows );
-                         auto const oColMirror = findMirror( pattern.cols );
-
-                         auto found = false;
-                         for( std::size_t r = 0; r < pattern.height; ++r )
-                         {
-                             for( std::size_t c = 0; c < pattern.width; ++c )
-                             {
-                                 pattern.flipPoint( c, r );
-
-                                 auto const rowMirror = findMirror( pattern.rows, oRowMirror );
-                                 if( rowMirror )
-                                 {
-                                     sum += rowMirror.value();
-                                     found = true;
-                                 }
-
-                                 auto const colMirror = findMirror( pattern.cols, oColMirror );
-                                 if( colMirror )
-                                 {
-                                     sum += colMirror.value() * 100;
-                                     found = true;
-                                 }
-                                 pattern.flipPoint( c, r );
-
-                                 if( found )
-                                 {
-                                     break;
-                                 }
-                             }
-                             if( found )
-                             {
-                                 break;
-                             }
-                         }
-                     } );
-
-    fmt::print( "Sum: {}\n", sum );
-
-    return EXIT_SUCCESS;
+    return sum;
 }
 
 namespace
 {
-    void iteratePatterns( std::istream& stream,
-                          std::function< void( Pattern const& ) > const& callback )
+    std::vector< Pattern > readPatterns( std::istream& stream )
     {
-        auto rows = std::vector< std::string >{};
-        auto line = std::string{};
-        while( std::getline( stream, line ) )
+        auto patterns = std::vector< Pattern >{};
+        auto lines = std::vector< std::string >{};
+
+        for( auto const& line : readLines( stream ) )
         {
-            if( line.length() == 0 && !rows.empty() )
+            if( line.empty() )
             {
-                callback( Pattern{ std::move( rows ) } );
+                if( !lines.empty() )
+                {
+                    patterns.emplace_back( lines );
+                    lines.clear();
+                }
             }
             else
             {
-                rows.push_back( line );
+                lines.push_back( line );
             }
         }
 
-        if( !rows.empty() )
+        if( !lines.empty() )
         {
-            callback( Pattern{ std::move( rows ) } );
+            patterns.emplace_back( lines );
         }
+
+        return patterns;
     }
 
-    Pattern::Pattern( std::vector< std::string > rowValues )
-        : width{ rowValues[ 0 ].size() }, height{ rowValues.size() }, rows{ std::move( rowValues ) }
+    Pattern::Pattern( std::vector< std::string > const& lines )
+        : rows( lines.size(), 0 ), cols( lines[ 0 ].size(), 0 )
     {
-        for( std::size_t c = 0; c < width; ++c )
+        if( rows.size() > 64 || cols.size() > 64 )
         {
-            auto s = std::ostringstream{};
-            for( std::size_t r = 0; r < height; ++r )
+            throw std::runtime_error(
+                fmt::format( "Pattern of size {}x{} exceeds 64 cells", cols.size(), rows.size() ) );
+        }
+
+        for( std::size_t y = 0; y < rows.size(); ++y )
+        {
+            if( lines[ y ].size() != cols.size() )
             {
-                s << rows[ r ][ c ];
+                throw std::runtime_error( fmt::format(
+                    "Row {} has width {} instead of {}", y, lines[ y ].size(), cols.size() ) );
+            }
+
+            for( std::size_t x = 0; x < cols.size(); ++x )
+            {
+                if( lines[ y ][ x ] == '#' )
+                {
+                    rows[ y ] |= std::uint64_t{ 1 } << x;
+                    cols[ x ] |= std::uint64_t{ 1 } << y;
+                }
             }
-            cols.push_back( s.str() );
         }
     }
 
-    std::vector< std::size_t > getMirrorPoints( std::string const& row )
+    std::optional< std::size_t > findMirror( std::vector< std::uint64_t > const& lines,
+                                             int smudges )
     {
-        auto mirrorPoints = std::vector< std::size_t >{};
-
-        for( std::size_t i = 1; i < row.length(); ++i )
+        for( std::size_t i = 1; i < lines.size(); ++i )
         {
-            auto isMirror = true;
+            auto diff = 0;
 
-            for( std::size_t j = 0; j < std::min( row.size() - i, i ); ++j )
+            for( std::size_t j = 0; j < std::min( lines.size() - i, i ) && diff <= smudges; ++j )
             {
-                if( row[ i + j ] != row[ i - 1 - j ] )
-                {
-                    isMirror = false;
-                    break;
-                }
+                diff += std::popcount( lines[ i - 1 - j ] ^ lines[ i + j ] );
             }
 
-            if( isMirror )
+            if( diff == smudges )
             {
-                mirrorPoints.push_back( i );
+                return i;
             }
         }
 
-        return mirrorPoints;
+        return {};
     }
 
-    std::optional< std::size_t > findMirror( std::vector< std::string > const& rows,
-                                             std::optional< std::size_t > exclude )
+    long summarize( Pattern const& pattern, int smudges )
     {
-        auto mirrors = std::vector< std::size_t >( rows[ 0 ].size(), 0 );
-        std::iota( std::begin( mirrors ), std::end( mirrors ), 0 );
-
-        if( exclude )
-        {
-            mirrors.erase(
-                std::remove( std::begin( mirrors ), std::end( mirrors ), exclude.value() ),
-                std::end( mirrors ) );
-        }
-
-        auto newMirrors = std::vector< std::size_t >{};
-        for( auto const& row : rows )
-        {
-            auto const rowMirrors = getMirrorPoints( row );
-            std::set_intersection( std::begin( rowMirrors ),
-                                   std::end( rowMirrors ),
-                                   std::begin( mirrors ),
-                                   std::end( mirrors ),
-                                   std::back_inserter( newMirrors ) );
-            mirrors = std::move( newMirrors );
-        }
-
-        if( mirrors.empty() )
+        if( auto const col = findMirror( pattern.cols, smudges ) )
         {
-            return {};
+            return static_cast< long >( col.value() );
         }
 
-        if( mirrors.size() > 1 )
+        if( auto const row = findMirror( pattern.rows, smudges ) )
         {
-            throw std::runtime_error( "Multiple mirrors!" );
+            return static_cast< long >( row.value() ) * 100;
         }
 
-        return mirrors[ 0 ];
-    }
-
-    void Pattern::flipPoint( std::size_t x, std::size_t y )
-    {
-        rows[ y ][ x ] = rows[ y ][ x ] == '.' ? '#' : '.';
-        cols[ x ][ y ] = cols[ x ][ y ] == '.' ? '#' : '.';
+        throw std::runtime_error( "Pattern without reflection" );
     }
 }
@@ -1,17 +1,13 @@
-#include <chrono>
-#include <cmath>
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <fmt/core.h>
-#include <fmt/format.h>
-#include <fmt/ranges.h>
 #include <fstream>
-#include <functional>
 #include <iostream>
-#include <numeric>
-#include <regex>
-#include <set>
-#include <thread>
-#include <unordered_set>
+#include <string>
+#include <string_view>
 
 #include <omp.h>
 
@@ -20,51 +16,138 @@
 
 namespace
 {
+    // Number of steps hashed together, one per SIMD lane
+    constexpr auto LANES = 16uz;
+
+    using StepBatch = std::array< std::string_view, LANES >;
+
+    // Splits the initialization sequence at commas. Line breaks are ignored, even within a step.
+    // Steps are views into the text, only the rare ones containing a line break are copied without
+    // it. All of them stay valid as long as the tokenizer.
+    class StepTokenizer
+    {
+    public:
+        explicit StepTokenizer( std::string_view text );
+
+        // Fills the batch with the next steps and returns their number. Unused lanes are empty.
+        std::size_t next( StepBatch& steps );
+
+    private:
+        std::string_view m_text;
+        std::deque< std::string > m_strippedSteps;
+    };
+
+    // HASH of the step in each lane using 8 bit wraparound instead of modulo arithmetic
+    std::array< std::uint8_t, LANES > hashSteps( StepBatch const& steps );
 }
 
 
-int main( int argc, char** argv )
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
+
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_example_1.txt", 1320 },
+    { "input_example_2.txt", 1320 },
+    { "input_final.txt", 512283 },
+};
+
+long Application::computeResult( std::istream& inputStream )
 {
-    if( argc < 2 )
+    auto const text = readAll( inputStream );
+    auto const chunks = splitChunks( text, 4 * omp_get_max_threads(), ',' );
+
+    auto sum = 0L;
+
+#pragma omp parallel for reduction( + : sum )
+    for( std::size_t i = 0; i < chunks.size(); ++i )
     {
-        std::cerr << "Missing parameter: <input file>\n";
-        return EXIT_FAILURE;
+        auto tokenizer = StepTokenizer{ chunks[ i ] };
+        auto steps = StepBatch{};
+
+        while( tokenizer.next( steps ) > 0 )
+        {
+            for( auto const hash : hashSteps( steps ) )
+            {
+                sum += hash;
+            }
+        }
     }
 
-    auto const fileName = std::string{ argv[ 1 ] };
-    auto fileStream = std::ifstream{ fileName };
+    return sum;
+}
 
-    auto word = std::string{};
 
+namespace
+{
+    constexpr auto DELIMITER = ',';
+    constexpr auto LINE_BREAKS = std::string_view{ "\r\n" };
 
-    auto sum = 0L;
-    while( std::getline( fileStream, word, ',' ) )
+    StepTokenizer::StepTokenizer( std::string_view text ) : m_text{ text }
     {
-        fmt::print( "{}\n", word );
+    }
 
-        auto value = 0L;
+    std::size_t StepTokenizer::next( StepBatch& steps )
+    {
+        auto count = 0uz;
 
-        for( auto c : word )
+        while( count < steps.size() && !m_text.empty() )
         {
-            if( c == '\n' )
+            auto const end = std::min( m_text.find( DELIMITER ), m_text.size() );
+            auto step = m_text.substr( 0, end );
+            m_text.remove_prefix( std::min( end + 1, m_text.size() ) );
+
+            if( step.find_first_of( LINE_BREAKS ) != std::string_view::npos )
+            {
+                auto& stripped = m_strippedSteps.emplace_back( step );
+                std::erase_if( stripped,
+                               []( char c )
+                               {
+                                   return LINE_BREAKS.contains( c );
+                               } );
+                step = stripped;
+            }
+
+            // Skips the line break at the end of the text
+            if( !step.empty() )
             {
-                continue;
+                steps[ count++ ] = step;
             }
-            value += c;
-            value *= 17;
-            value %= 256;
         }
 
-        fmt::print( "Value: {}\n", value );
+        std::fill( std::begin( steps ) + count, std::end( steps ), std::string_view{} );
 
-        sum += value;
+        return count;
     }
 
-    fmt::print( "Value: {}\n", sum );
+    std::array< std::uint8_t, LANES > hashSteps( StepBatch const& steps )
+    {
+        auto maxLength = 0uz;
+        for( auto const step : steps )
+        {
+            maxLength = std::max( maxLength, step.size() );
+        }
 
-    return EXIT_SUCCESS;
-}
+        auto hashes = std::array< std::uint8_t, LANES >{};
+        auto column = std::array< std::uint8_t, LANES >{};
+        auto active = std::array< std::uint8_t, LANES >{};
 
-namespace
-{
+        for( auto i = 0uz; i < maxLength; ++i )
+        {
+            // Character i of every lane, lanes with shorter steps keep their hash
+            for( auto lane = 0uz; lane < LANES; ++lane )
+            {
+                active[ lane ] = i < steps[ lane ].size();
+                column[ lane ] = active[ lane ] ? steps[ lane ][ i ] : 0;
+            }
+
+#pragma omp simd
+            for( auto lane = 0uz; lane < LANES; ++lane )
+            {
+                auto const hash =
+                    static_cast< std::uint8_t >( ( hashes[ lane ] + column[ lane ] ) * 17 );
+                hashes[ lane ] = active[ lane ] ? hash : hashes[ lane ];
+            }
+        }
+
+        return hashes;
+    }
 }
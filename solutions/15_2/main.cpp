@@ -1,139 +1,344 @@
-#include <chrono>
-#include <cmath>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <fmt/core.h>
-#include <fmt/format.h>
-#include <fmt/ranges.h>
 #include <fstream>
-#include <functional>
 #include <iostream>
-#include <numeric>
-#include <regex>
-#include <set>
-#include <thread>
-#include <unordered_set>
-
-#include <omp.h>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include <utils.hpp>
 
 
 namespace
 {
-    struct Lens
+    // Number of steps hashed together, one per SIMD lane
+    constexpr auto LANES = 16uz;
+
+    using StepBatch = std::array< std::string_view, LANES >;
+
+    // Splits the initialization sequence at commas. Line breaks are ignored, even within a step.
+    // Steps are views into the text, only the rare ones containing a line break are copied without
+    // it. All of them stay valid as long as the tokenizer.
+    class StepTokenizer
     {
-        std::string key;
-        int focalLength;
+    public:
+        explicit StepTokenizer( std::string_view text );
+
+        // Fills the batch with the next steps and returns their number. Unused lanes are empty.
+        std::size_t next( StepBatch& steps );
+
+    private:
+        std::string_view m_text;
+        std::deque< std::string > m_strippedSteps;
+    };
+
+    using LabelId = std::uint32_t;
+
+    // Assigns dense ids to labels in order of first appearance
+    class LabelTable
+    {
+    public:
+        LabelId intern( std::string_view label );
+
+    private:
+        std::unordered_map< std::string_view, LabelId > m_ids;
+    };
+
+    // Lenses of all boxes. Each box keeps its lenses in insertion order. Removed lenses stay as
+    // tombstones until they outnumber the remaining ones and the box is compacted.
+    class LensBoxes
+    {
+    public:
+        explicit LensBoxes( std::size_t boxCount );
+
+        void insert( std::size_t box, LabelId label, int focalLength );
+
+        void remove( std::size_t box, LabelId label );
+
+        long computeFocusingPower() const;
+
+    private:
+        static constexpr auto NO_SLOT = std::numeric_limits< std::uint32_t >::max();
+
+        // A focal length of 0 marks a removed lens
+        struct Slot
+        {
+            LabelId label;
+            int focalLength;
+        };
+
+        struct Box
+        {
+            std::vector< Slot > slots;
+            std::size_t tombstones{ 0 };
+        };
+
+        void compact( Box& box );
+
+        std::vector< Box > m_boxes;
+
+        // Index of the slot of each label within its box. A label always hashes to the same box.
+        std::vector< std::uint32_t > m_slots;
     };
 
-    struct Box
+    // Step split into its label and operation. A focal length of 0 removes the lens.
+    struct Step
     {
-        std::vector< Lens > lenses;
+        std::string_view label;
+        int focalLength;
     };
 
-    int computeHash( std::string const& word )
+    Step parseStep( std::string_view step );
+
+
+    // HASH of the step in each lane using 8 bit wraparound instead of modulo arithmetic
+    std::array< std::uint8_t, LANES > hashSteps( StepBatch const& steps );
+}
+
+
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
+
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_example_1.txt", 145 },
+    { "input_example_2.txt", 145 },
+    { "input_final.txt", 215827 },
+};
+
+long Application::computeResult( std::istream& inputStream )
+{
+    auto const text = readAll( inputStream );
+
+    auto labelTable = LabelTable{};
+    auto boxes = LensBoxes{ 256 };
+    auto tokenizer = StepTokenizer{ text };
+    auto steps = StepBatch{};
+    auto labels = StepBatch{};
+    auto parsed = std::array< Step, LANES >{};
+
+    while( auto const count = tokenizer.next( steps ) )
     {
-        auto hash = 0L;
+        for( auto i = 0uz; i < count; ++i )
+        {
+            parsed[ i ] = parseStep( steps[ i ] );
+            labels[ i ] = parsed[ i ].label;
+        }
 
-        for( auto c : word )
+        auto const hashes = hashSteps( labels );
+
+        // The steps of a batch may target the same box, so they are applied in order
+        for( auto i = 0uz; i < count; ++i )
         {
-            if( c == '\n' )
+            auto const label = labelTable.intern( parsed[ i ].label );
+
+            if( parsed[ i ].focalLength == 0 )
             {
-                continue;
+                boxes.remove( hashes[ i ], label );
+            }
+            else
+            {
+                boxes.insert( hashes[ i ], label, parsed[ i ].focalLength );
             }
-            hash += c;
-            hash *= 17;
-            hash %= 256;
         }
-
-        return hash;
     }
+
+    return boxes.computeFocusingPower();
 }
 
 
-int main( int argc, char** argv )
+namespace
 {
-    if( argc < 2 )
+    constexpr auto DELIMITER = ',';
+    constexpr auto LINE_BREAKS = std::string_view{ "\r\n" };
+
+    StepTokenizer::StepTokenizer( std::string_view text ) : m_text{ text }
     {
-        std::cerr << "Missing parameter: <input file>\n";
-        return EXIT_FAILURE;
     }
 
-    auto const fileName = std::string{ argv[ 1 ] };
-    auto fileStream = std::ifstream{ fileName };
+    std::size_t StepTokenizer::next( StepBatch& steps )
+    {
+        auto count = 0uz;
 
-    auto word = std::string{};
+        while( count < steps.size() && !m_text.empty() )
+        {
+            auto const end = std::min( m_text.find( DELIMITER ), m_text.size() );
+            auto step = m_text.substr( 0, end );
+            m_text.remove_prefix( std::min( end + 1, m_text.size() ) );
 
-    auto boxes = std::vector< Box >( 256 );
+            if( step.find_first_of( LINE_BREAKS ) != std::string_view::npos )
+            {
+                auto& stripped = m_strippedSteps.emplace_back( step );
+                std::erase_if( stripped,
+                               []( char c )
+                               {
+                                   return LINE_BREAKS.contains( c );
+                               } );
+                step = stripped;
+            }
 
-    while( std::getline( fileStream, word, ',' ) )
+            // Skips the line break at the end of the text
+            if( !step.empty() )
+            {
+                steps[ count++ ] = step;
+            }
+        }
+
+        std::fill( std::begin( steps ) + count, std::end( steps ), std::string_view{} );
+
+        return count;
+    }
+
+    Step parseStep( std::string_view step )
     {
-        fmt::print( "{}\n", word );
+        auto const operation = step.find_first_of( "=-" );
+        if( operation == std::string_view::npos || operation == 0 )
+        {
+            throw std::runtime_error( fmt::format( "Invalid step: {}", step ) );
+        }
 
-        auto const pattern = std::regex{ R"(^(\w+)([=-])(\d*)[\n]?)" };
-        auto match = std::smatch{};
-        if( !std::regex_match( word, match, pattern ) )
+        auto result = Step{ step.substr( 0, operation ), 0 };
+
+        if( step[ operation ] == '-' )
         {
-            continue;
+            if( operation + 1 != step.size() )
+            {
+                throw std::runtime_error( fmt::format( "Invalid step: {}", step ) );
+            }
+
+            return result;
         }
 
-        auto const key = match[ 1 ].str();
-        auto const instruction = match[ 2 ].str();
+        auto const* const begin = step.data() + operation + 1;
+        auto const* const end = step.data() + step.size();
+        auto const [ ptr, ec ] = std::from_chars( begin, end, result.focalLength );
 
-        auto const hash = computeHash( key );
-        fmt::print( "Hash: {} {}\n", key, hash );
-        auto& box = boxes[ hash ];
+        if( ec != std::errc{} || ptr != end || begin == end || result.focalLength <= 0 )
+        {
+            throw std::runtime_error( fmt::format( "Invalid focal length: {}", step ) );
+        }
+
+        return result;
+    }
 
-        if( instruction[ 0 ] == '=' )
+    LabelId LabelTable::intern( std::string_view label )
+    {
+        auto const [ iter, inserted ] =
+            m_ids.try_emplace( label, static_cast< LabelId >( m_ids.size() ) );
+        return iter->second;
+    }
+
+    LensBoxes::LensBoxes( std::size_t boxCount ) : m_boxes( boxCount )
+    {
+    }
+
+    void LensBoxes::insert( std::size_t box, LabelId label, int focalLength )
+    {
+        if( label >= m_slots.size() )
         {
-            auto const focalLength = std::stoi( match[ 3 ] );
+            m_slots.resize( std::max( label + 1uz, m_slots.size() * 2 ), NO_SLOT );
+        }
 
-            auto const iter = std::find_if( std::begin( box.lenses ),
-                                            std::end( box.lenses ),
-                                            [ & ]( auto const& lens )
-                                            {
-                                                return lens.key == key;
-                                            } );
+        auto& slots = m_boxes[ box ].slots;
 
-            if( iter == std::end( box.lenses ) )
-            {
-                box.lenses.push_back( Lens{ key, focalLength } );
-            }
-            else
-            {
-                ( *iter ).key = key;
-                ( *iter ).focalLength = focalLength;
-            }
+        if( m_slots[ label ] == NO_SLOT )
+        {
+            m_slots[ label ] = static_cast< std::uint32_t >( slots.size() );
+            slots.push_back( Slot{ label, focalLength } );
         }
         else
         {
-            box.lenses.erase( std::remove_if( std::begin( box.lenses ),
-                                              std::end( box.lenses ),
-                                              [ & ]( auto const& lens )
-                                              {
-                                                  return lens.key == key;
-                                              } ),
-                              std::end( box.lenses ) );
+            slots[ m_slots[ label ] ].focalLength = focalLength;
         }
     }
 
-    auto sum = 0L;
-    for( int b = 0; b < boxes.size(); ++b )
+    void LensBoxes::remove( std::size_t box, LabelId label )
     {
-        auto const& box = boxes[ b ];
-        fmt::print( "Box\n" );
-        for( int i = 0; i < box.lenses.size(); ++i )
+        if( label >= m_slots.size() || m_slots[ label ] == NO_SLOT )
         {
-            fmt::print( "Lens {} {}\n", i, box.lenses[ i ].key );
-            sum += ( b + 1 ) * ( i + 1 ) * box.lenses[ i ].focalLength;
+            return;
+        }
+
+        auto& target = m_boxes[ box ];
+        target.slots[ m_slots[ label ] ].focalLength = 0;
+        m_slots[ label ] = NO_SLOT;
+
+        if( ++target.tombstones * 2 > target.slots.size() )
+        {
+            compact( target );
         }
     }
 
-    fmt::print( "Value: {}\n", sum );
+    long LensBoxes::computeFocusingPower() const
+    {
+        auto sum = 0L;
 
-    return EXIT_SUCCESS;
-}
+        for( std::size_t b = 0; b < m_boxes.size(); ++b )
+        {
+            auto position = 0L;
+            for( auto const& slot : m_boxes[ b ].slots )
+            {
+                if( slot.focalLength != 0 )
+                {
+                    sum += static_cast< long >( b + 1 ) * ++position * slot.focalLength;
+                }
+            }
+        }
 
-namespace
-{
+        return sum;
+    }
+
+    void LensBoxes::compact( Box& box )
+    {
+        auto size = 0uz;
+
+        for( auto const& slot : box.slots )
+        {
+            if( slot.focalLength != 0 )
+            {
+                m_slots[ slot.label ] = static_cast< std::uint32_t >( size );
+                box.slots[ size++ ] = slot;
+            }
+        }
+
+        box.slots.resize( size );
+        box.tombstones = 0;
+    }
+
+    std::array< std::uint8_t, LANES > hashSteps( StepBatch const& steps )
+    {
+        auto maxLength = 0uz;
+        for( auto const step : steps )
+        {
+            maxLength = std::max( maxLength, step.size() );
+        }
+
+        auto hashes = std::array< std::uint8_t, LANES >{};
+        auto column = std::array< std::uint8_t, LANES >{};
+        auto active = std::array< std::uint8_t, LANES >{};
+
+        for( auto i = 0uz; i < maxLength; ++i )
+        {
+            // Character i of every lane, lanes with shorter steps keep their hash
+            for( auto lane = 0uz; lane < LANES; ++lane )
+            {
+                active[ lane ] = i < steps[ lane ].size();
+                column[ lane ] = active[ lane ] ? steps[ lane ][ i ] : 0;
+            }
+
+#pragma omp simd
+            for( auto lane = 0uz; lane < LANES; ++lane )
+            {
+                auto const hash =
+                    static_cast< std::uint8_t >( ( hashes[ lane ] + column[ lane ] ) * 17 );
+                hashes[ lane ] = active[ lane ] ? hash : hashes[ lane ];
+            }
+        }
+
+        return hashes;
+    }
 }
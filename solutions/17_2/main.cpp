@@ -31,8 +31,9 @@ namespace
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 51 },
-    { "input_final.txt", 7987 },
+    { "input_example.txt", 94 },
+    { "input_example_2.txt", 71 },
+    { "input_final.txt", 801 },
 };
 
 long Application::computeResult( std::istream& inputStream )
@@ -208,10 +209,10 @@ namespace
             int y;
         };
 
-        auto prev = std::unordered_map< Node, Node >{};
+        auto prev = FlatHashMap< Node, Node >{};
         auto heuristic = computeHeuristic( grid, tx, ty );
-        auto openlist = std::unordered_set< Node >{};
-        auto visited = std::unordered_set< Node >{};
+        auto openlist = FlatHashSet< Node >{};
+        auto visited = FlatHashSet< Node >{};
 
         openlist.insert( Node{ sx, sy, 0, Dir::NONE, 0, heuristic( sx, sy ) } );
 
@@ -1,19 +1,15 @@
 #include <algorithm>
-#include <chrono>
-#include <cmath>
+#include <array>
+#include <charconv>
+#include <cstdint>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fmt/format.h>
-#include <fmt/ranges.h>
 #include <fstream>
-#include <functional>
 #include <iostream>
-#include <numeric>
-#include <queue>
-#include <regex>
-#include <set>
-#include <thread>
-#include <unordered_set>
+#include <limits>
+#include <optional>
+#include <string_view>
 
 #include <omp.h>
 
@@ -22,116 +18,170 @@
 
 namespace
 {
-    enum class Dir : int
+    struct Pos
     {
-        RIGHT,
-        UP,
-        LEFT,
-        DOWN,
+        long x;
+        long y;
     };
 
-    Dir dirFromChar( char c );
-
-    struct Instruction
+    struct Step
     {
-        Dir dir;
-        int len;
-        std::string color;
-
-        static Instruction parse( std::string const& line );
+        int dir;
+        long len;
     };
 
-    struct Pos
+    // Part of the dig plan with all positions relative to the position at its start
+    struct Trench
     {
-        int x;
-        int y;
+        Pos end{ 0, 0 };
+
+        // Twice the signed shoelace area of the edges of the part
+        __int128 doubleArea{ 0 };
+
+        long length{ 0 };
+        long invalid{ 0 };
     };
 
-    std::generator< Pos > traverse( std::vector< Instruction > const& instructions, Pos start );
+    // Parses the direction and length at the start of the line, e.g. "R 6 (#70c710)"
+    std::optional< Step > parseStep( std::string_view line );
+
+    Trench digChunk( std::string_view chunk );
+
+    // Trench of `lhs` followed by `rhs`, where `rhs` starts at the end of `lhs`
+    Trench append( Trench const& lhs, Trench const& rhs );
 }
 
 
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 51 },
-    { "input_final.txt", 7987 },
+    { "input_example.txt", 62 },
+    { "input_example_2.txt", 4 },
+    { "input_final.txt", 72821 },
 };
 
 long Application::computeResult( std::istream& inputStream )
 {
-    auto instructions = std::vector< Instruction >{};
+    auto const text = readAll( inputStream );
+    auto const chunks = splitLineChunks( text, 4 * omp_get_max_threads() );
+
+    auto trenches = std::vector< Trench >( chunks.size() );
 
-    for( auto const& line : readLines( inputStream ) )
+#pragma omp parallel for
+    for( std::size_t i = 0; i < chunks.size(); ++i )
     {
-        instructions.push_back( Instruction::parse( line ) );
+        trenches[ i ] = digChunk( chunks[ i ] );
     }
 
-    auto prevPos = Pos{ 0, 0 };
+    // The chunks are joined in order, which shifts each one to the end position of its prefix
+    auto trench = Trench{};
+    for( auto const& chunk : trenches )
+    {
+        trench = append( trench, chunk );
+    }
 
-    auto area = 0L;
-    auto tiles = 0L;
-    for( auto const& pos : traverse( instructions, Pos{ 0, 0 } ) )
+    if( trench.invalid > 0 )
     {
-        area += ( prevPos.y + pos.y ) * ( prevPos.x - pos.x );
-        tiles += std::abs( ( pos.x - prevPos.x ) + ( pos.y - prevPos.y ) );
-        prevPos = pos;
+        throw std::runtime_error( fmt::format( "{} invalid lines", trench.invalid ) );
     }
 
-    auto const innerTiles = std::abs( area / 2 ) - ( tiles - 4 ) / 2 - 1;
-    auto const total = innerTiles + tiles;
+    if( trench.end.x != 0 || trench.end.y != 0 )
+    {
+        throw std::runtime_error( "Dig plan does not return to its start" );
+    }
 
-    fmt::print( "Area: {} {}\n", area, tiles );
-    fmt::print( "Result: {} {}\n", innerTiles, total );
+    // Pick's theorem: the interior plus the trench itself
+    auto const area = ( trench.doubleArea < 0 ? -trench.doubleArea : trench.doubleArea ) / 2;
+    auto const total = area + trench.length / 2 + 1;
 
-    return total;
+    if( total > std::numeric_limits< long >::max() )
+    {
+        throw std::overflow_error( "Lagoon volume exceeds long" );
+    }
+
+    return static_cast< long >( total );
 }
 
+
 namespace
 {
-    Dir dirFromChar( char c )
-    {
-        auto const DIRS = std::unordered_map< char, Dir >{
-            { 'R', Dir::RIGHT },
-            { 'U', Dir::UP },
-            { 'L', Dir::LEFT },
-            { 'D', Dir::DOWN },
-        };
-        return DIRS.at( c );
-    }
+    // Offsets of the direction digits 0 to 3 (right, down, left, up)
+    constexpr auto DX = std::array< long, 4 >{ 1, 0, -1, 0 };
+    constexpr auto DY = std::array< long, 4 >{ 0, 1, 0, -1 };
 
-    Instruction Instruction::parse( std::string const& line )
+    // Direction index of each letter, -1 for all other characters
+    constexpr auto DIR_LETTERS = []
+    {
+        auto dirs = std::array< std::int8_t, 256 >{};
+        dirs.fill( -1 );
+        dirs[ 'R' ] = 0;
+        dirs[ 'D' ] = 1;
+        dirs[ 'L' ] = 2;
+        dirs[ 'U' ] = 3;
+        return dirs;
+    }();
+
+    std::optional< Step > parseStep( std::string_view line )
     {
-        auto const PATTERN = std::regex{ R"(^([RULD])\s+(\d+)\s+\(#([a-f0-9]{6})\)\n?$)" };
-        auto match = std::smatch{};
-        if( !std::regex_match( line, match, PATTERN ) )
+        if( line.size() < 3 || line[ 1 ] != ' ' )
         {
-            throw std::runtime_error( fmt::format( "Mismatch: {}\n", line ) );
+            return std::nullopt;
         }
 
-        auto const dir = dirFromChar( match[ 1 ].str()[ 0 ] );
-        return Instruction{ dir, std::stoi( match[ 2 ] ), match[ 3 ] };
+        auto const dir = DIR_LETTERS[ static_cast< unsigned char >( line[ 0 ] ) ];
+
+        auto len = 0L;
+        auto const* const end = line.data() + line.size();
+        auto const [ ptr, ec ] = std::from_chars( line.data() + 2, end, len );
+
+        if( dir < 0 || ec != std::errc{} || ( ptr != end && *ptr != ' ' ) || len < 0 )
+        {
+            return std::nullopt;
+        }
+
+        return Step{ dir, len };
     }
 
-    std::generator< Pos > traverse( std::vector< Instruction > const& instructions, Pos start )
+    Trench digChunk( std::string_view chunk )
     {
-        for( auto const& instr : instructions )
+        auto trench = Trench{};
+
+        for( auto const line : splitLines( chunk ) )
         {
-            switch( instr.dir )
+            if( line.empty() )
             {
-                case Dir::RIGHT:
-                    start.x += instr.len;
-                    break;
-                case Dir::UP:
-                    start.y -= instr.len;
-                    break;
-                case Dir::LEFT:
-                    start.x -= instr.len;
-                    break;
-                case Dir::DOWN:
-                    start.y += instr.len;
+                continue;
             }
-            co_yield start;
+
+            auto const step = parseStep( line );
+            if( !step )
+            {
+                ++trench.invalid;
+                continue;
+            }
+
+            auto const next = Pos{ trench.end.x + DX[ step->dir ] * step->len,
+                                   trench.end.y + DY[ step->dir ] * step->len };
+
+            trench.doubleArea += static_cast< __int128 >( trench.end.x ) * next.y -
+                                 static_cast< __int128 >( next.x ) * trench.end.y;
+            trench.length += step->len;
+            trench.end = next;
         }
+
+        return trench;
+    }
+
+    Trench append( Trench const& lhs, Trench const& rhs )
+    {
+        // Shifting all vertices of `rhs` by the end of `lhs` adds the cross product of that shift
+        // with the displacement of `rhs` to its shoelace sum
+        auto const shift = static_cast< __int128 >( lhs.end.x ) * rhs.end.y -
+                           static_cast< __int128 >( lhs.end.y ) * rhs.end.x;
+
+        return Trench{ Pos{ lhs.end.x + rhs.end.x, lhs.end.y + rhs.end.y },
+                       lhs.doubleArea + rhs.doubleArea + shift,
+                       lhs.length + rhs.length,
+                       lhs.invalid + rhs.invalid };
     }
 }
@@ -1,19 +1,14 @@
 #include <algorithm>
-#include <chrono>
-#include <cmath>
+#include <array>
+#include <cstdint>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fmt/format.h>
-#include <fmt/ranges.h>
 #include <fstream>
-#include <functional>
 #include <iostream>
-#include <numeric>
-#include <queue>
-#include <regex>
-#include <set>
-#include <thread>
-#include <unordered_set>
+#include <limits>
+#include <optional>
+#include <string_view>
 
 #include <omp.h>
 
@@ -22,112 +17,184 @@
 
 namespace
 {
-    enum class Dir : int
+    struct Pos
     {
-        RIGHT,
-        UP,
-        LEFT,
-        DOWN,
+        long x;
+        long y;
     };
 
-    Dir dirFromChar( char c );
-
-    struct Instruction
+    struct Step
     {
-        Dir dir;
-        int len;
-
-        static Instruction parse( std::string const& line );
+        int dir;
+        long len;
     };
 
-    struct Pos
+    // Part of the dig plan with all positions relative to the position at its start
+    struct Trench
     {
-        long x;
-        long y;
+        Pos end{ 0, 0 };
+
+        // Twice the signed shoelace area of the edges of the part
+        __int128 doubleArea{ 0 };
+
+        long length{ 0 };
+        long invalid{ 0 };
     };
 
-    std::generator< Pos > traverse( std::vector< Instruction > const& instructions, Pos start );
+    // Parses the step encoded in the color, e.g. "(#70c710)" for 461937 to the right
+    std::optional< Step > parseStep( std::string_view line );
+
+    Trench digChunk( std::string_view chunk );
+
+    // Trench of `lhs` followed by `rhs`, where `rhs` starts at the end of `lhs`
+    Trench append( Trench const& lhs, Trench const& rhs );
 }
 
 
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 51 },
-    { "input_final.txt", 7987 },
+    { "input_example.txt", 952408144115 },
+    { "input_final.txt", 127844509405501 },
 };
 
 long Application::computeResult( std::istream& inputStream )
 {
-    auto instructions = std::vector< Instruction >{};
+    auto const text = readAll( inputStream );
+    auto const chunks = splitLineChunks( text, 4 * omp_get_max_threads() );
 
-    for( auto const& line : readLines( inputStream ) )
+    auto trenches = std::vector< Trench >( chunks.size() );
+
+#pragma omp parallel for
+    for( std::size_t i = 0; i < chunks.size(); ++i )
+    {
+        trenches[ i ] = digChunk( chunks[ i ] );
+    }
+
+    // The chunks are joined in order, which shifts each one to the end position of its prefix
+    auto trench = Trench{};
+    for( auto const& chunk : trenches )
     {
-        instructions.push_back( Instruction::parse( line ) );
+        trench = append( trench, chunk );
     }
 
-    auto prevPos = Pos{ 0, 0 };
+    if( trench.invalid > 0 )
+    {
+        throw std::runtime_error( fmt::format( "{} invalid lines", trench.invalid ) );
+    }
 
-    auto area = 0L;
-    auto tiles = 0L;
-    for( auto const& pos : traverse( instructions, Pos{ 0, 0 } ) )
+    if( trench.end.x != 0 || trench.end.y != 0 )
     {
-        area += ( prevPos.y + pos.y ) * ( prevPos.x - pos.x );
-        tiles += std::abs( ( pos.x - prevPos.x ) + ( pos.y - prevPos.y ) );
-        prevPos = pos;
+        throw std::runtime_error( "Dig plan does not return to its start" );
     }
 
-    auto const innerTiles = std::abs( area / 2 ) - ( tiles - 4 ) / 2 - 1;
-    auto const total = innerTiles + tiles;
+    // Pick's theorem: the interior plus the trench itself
+    auto const area = ( trench.doubleArea < 0 ? -trench.doubleArea : trench.doubleArea ) / 2;
+    auto const total = area + trench.length / 2 + 1;
 
-    return total;
+    if( total > std::numeric_limits< long >::max() )
+    {
+        throw std::overflow_error( "Lagoon volume exceeds long" );
+    }
+
+    return static_cast< long >( total );
 }
 
+
 namespace
 {
-    Dir dirFromChar( char c )
+    // Offsets of the direction digits 0 to 3 (right, down, left, up)
+    constexpr auto DX = std::array< long, 4 >{ 1, 0, -1, 0 };
+    constexpr auto DY = std::array< long, 4 >{ 0, 1, 0, -1 };
+
+    // Value of each hexadecimal digit, -1 for all other characters
+    constexpr auto HEX_DIGITS = []
     {
-        auto const DIRS = std::unordered_map< char, Dir >{
-            { '0', Dir::RIGHT },
-            { '1', Dir::DOWN },
-            { '2', Dir::LEFT },
-            { '3', Dir::UP },
-        };
-        return DIRS.at( c );
-    }
+        auto digits = std::array< std::int8_t, 256 >{};
+        digits.fill( -1 );
 
-    Instruction Instruction::parse( std::string const& line )
+        for( auto c = 0; c < 10; ++c )
+        {
+            digits[ '0' + c ] = c;
+        }
+
+        for( auto c = 0; c < 6; ++c )
+        {
+            digits[ 'a' + c ] = 10 + c;
+            digits[ 'A' + c ] = 10 + c;
+        }
+
+        return digits;
+    }();
+
+    std::optional< Step > parseStep( std::string_view line )
     {
-        auto const PATTERN = std::regex{ R"(^([RULD])\s+(\d+)\s+\(#([a-f0-9]{5})([0-3])\)\n?$)" };
-        auto match = std::smatch{};
-        if( !std::regex_match( line, match, PATTERN ) )
+        auto const hash = line.find( '#' );
+        if( hash == std::string_view::npos || hash + 7 >= line.size() || line[ hash + 7 ] != ')' )
+        {
+            return std::nullopt;
+        }
+
+        // Invalid digits are negative and leave the sign bit set in `invalid`
+        auto invalid = 0;
+        auto len = 0L;
+        for( auto i = hash + 1; i < hash + 6; ++i )
+        {
+            auto const digit = HEX_DIGITS[ static_cast< unsigned char >( line[ i ] ) ];
+            invalid |= digit;
+            len = ( len << 4 ) | ( digit & 0xF );
+        }
+
+        auto const dir = static_cast< unsigned >( line[ hash + 6 ] - '0' );
+
+        if( invalid < 0 || dir >= DX.size() )
         {
-            throw std::runtime_error( fmt::format( "Mismatch: {}\n", line ) );
+            return std::nullopt;
         }
 
-        auto const dir = dirFromChar( match[ 4 ].str()[ 0 ] );
-        return Instruction{ dir, std::stoi( match[ 3 ].str(), nullptr, 16 ) };
+        return Step{ static_cast< int >( dir ), len };
     }
 
-    std::generator< Pos > traverse( std::vector< Instruction > const& instructions, Pos start )
+    Trench digChunk( std::string_view chunk )
     {
-        for( auto const& instr : instructions )
+        auto trench = Trench{};
+
+        for( auto const line : splitLines( chunk ) )
         {
-            switch( instr.dir )
+            if( line.empty() )
+            {
+                continue;
+            }
+
+            auto const step = parseStep( line );
+            if( !step )
             {
-                case Dir::RIGHT:
-                    start.x += instr.len;
-                    break;
-                case Dir::UP:
-                    start.y -= instr.len;
-                    break;
-                case Dir::LEFT:
-                    start.x -= instr.len;
-                    break;
-                case Dir::DOWN:
-                    start.y += instr.len;
+                ++trench.invalid;
+                continue;
             }
-            co_yield start;
+
+            auto const next = Pos{ trench.end.x + DX[ step->dir ] * step->len,
+                                   trench.end.y + DY[ step->dir ] * step->len };
+
+            trench.doubleArea += static_cast< __int128 >( trench.end.x ) * next.y -
+                                 static_cast< __int128 >( next.x ) * trench.end.y;
+            trench.length += step->len;
+            trench.end = next;
         }
+
+        return trench;
+    }
+
+    Trench append( Trench const& lhs, Trench const& rhs )
+    {
+        // Shifting all vertices of `rhs` by the end of `lhs` adds the cross product of that shift
+        // with the displacement of `rhs` to its shoelace sum
+        auto const shift = static_cast< __int128 >( lhs.end.x ) * rhs.end.y -
+                           static_cast< __int128 >( lhs.end.y ) * rhs.end.x;
+
+        return Trench{ Pos{ lhs.end.x + rhs.end.x, lhs.end.y + rhs.end.y },
+                       lhs.doubleArea + rhs.doubleArea + shift,
+                       lhs.length + rhs.length,
+                       lhs.invalid + rhs.invalid };
     }
 }
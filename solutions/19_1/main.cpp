@@ -1,6 +1,8 @@
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fmt/format.h>
@@ -22,148 +24,199 @@
 
 namespace
 {
-    struct Rule
+    constexpr auto NUM_PROPS = 4;
+
+    // Jump targets below zero terminate the program
+    constexpr auto ACCEPT = -1;
+    constexpr auto REJECT = -2;
+
+    enum class Comparison : std::uint8_t
     {
-        std::string prop;
-        char op;
-        long num;
-        std::string target;
+        LESS,
+        GREATER,
+        ALWAYS,
     };
 
-    struct Workflow
+    // Single rule of the flattened workflow program. Workflows are stored back to back, so a
+    // failed comparison falls through to the next rule of the same workflow. Workflow defaults
+    // are encoded as unconditional jumps.
+    struct Instruction
     {
-        std::vector< Rule > rules;
-        std::string def;
+        std::uint8_t prop;
+        Comparison comparison;
+        long value;
+        int target;
     };
 
-    struct Object
+    struct Program
     {
-        std::unordered_map< std::string, long > props;
+        std::vector< Instruction > instructions;
+        int entry;
+
+        bool run( std::array< long, NUM_PROPS > const& props ) const;
     };
 
-    bool checkWorkflow( std::unordered_map< std::string, Workflow > const& workflows,
-                        Object const& obj,
-                        std::string const& name );
+    // Ratings of all parts with one column per property
+    struct Parts
+    {
+        std::array< std::vector< long >, NUM_PROPS > props;
+
+        std::size_t size() const
+        {
+            return props[ 0 ].size();
+        }
+    };
+
+    std::uint8_t propIndex( std::string const& name );
+
+    Program compileWorkflows( std::istream& stream );
+
+    Parts loadParts( std::istream& stream );
 }
 
 
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 51 },
-    { "input_final.txt", 7987 },
+    { "input_example.txt", 19114 },
+    { "input_final.txt", 434147 },
 };
 
 long Application::computeResult( std::istream& inputStream )
 {
-    auto const PATTERN_WORKFLOW = std::regex{ R"((\w+)\{(.*),(\w+)\})" };
-    auto const PATTERN_RULE = std::regex{ R"((\w+)([<>])([-\d]+):(\w+))" };
-    auto const PATTERN_PROPS = std::regex{ R"((\w+)=([-\d]+))" };
+    auto const program = compileWorkflows( inputStream );
+    auto const parts = loadParts( inputStream );
+    auto const numParts = static_cast< long >( parts.size() );
 
-    auto workflows = std::unordered_map< std::string, Workflow >{};
+    auto sum = 0L;
 
-    for( auto const& line : readLines( inputStream ) )
+#pragma omp parallel for reduction( + : sum )
+    for( auto i = 0L; i < numParts; ++i )
     {
-        auto match = std::smatch{};
-        if( !std::regex_match( line, match, PATTERN_WORKFLOW ) )
+        auto const props = std::array< long, NUM_PROPS >{
+            parts.props[ 0 ][ i ],
+            parts.props[ 1 ][ i ],
+            parts.props[ 2 ][ i ],
+            parts.props[ 3 ][ i ],
+        };
+
+        if( program.run( props ) )
         {
-            break;
+            sum += props[ 0 ] + props[ 1 ] + props[ 2 ] + props[ 3 ];
         }
+    }
 
-        auto const name = match[ 1 ].str();
-        auto const ruleStr = match[ 2 ].str();
-        auto const def = match[ 3 ].str();
+    return sum;
+}
 
-        auto rules = std::vector< Rule >{};
 
-        auto const begin =
-            std::sregex_iterator{ std::begin( ruleStr ), std::end( ruleStr ), PATTERN_RULE };
-        auto const end = std::sregex_iterator{};
-        for( auto iter = begin; iter != end; ++iter )
-        {
-            auto const prop = ( *iter )[ 1 ].str();
-            auto const op = ( *iter )[ 2 ].str();
-            auto const num = ( *iter )[ 3 ].str();
-            auto const target = ( *iter )[ 4 ].str();
+namespace
+{
+    bool Program::run( std::array< long, NUM_PROPS > const& props ) const
+    {
+        auto pc = entry;
 
-            rules.push_back( Rule{ prop, op[ 0 ], std::stol( num ), target } );
+        while( pc >= 0 )
+        {
+            auto const& instr = instructions[ pc ];
+            auto const value = props[ instr.prop ];
+            auto const matches = instr.comparison == Comparison::ALWAYS ||
+                                 ( instr.comparison == Comparison::GREATER ? value > instr.value
+                                                                           : value < instr.value );
+            pc = matches ? instr.target : pc + 1;
         }
 
-        workflows.insert( { name, Workflow{ std::move( rules ), def } } );
+        return pc == ACCEPT;
     }
 
-    auto objects = std::vector< Object >{};
-    for( auto const& line : readLines( inputStream ) )
+    std::uint8_t propIndex( std::string const& name )
     {
-        auto props = std::unordered_map< std::string, long >{};
-
-        auto const begin =
-            std::sregex_iterator{ std::begin( line ), std::end( line ), PATTERN_PROPS };
-        auto const end = std::sregex_iterator{};
-        for( auto iter = begin; iter != end; ++iter )
+        auto const PROPS = std::unordered_map< std::string, std::uint8_t >{
+            { "x", 0 },
+            { "m", 1 },
+            { "a", 2 },
+            { "s", 3 },
+        };
+
+        auto const iter = PROPS.find( name );
+        if( iter == std::end( PROPS ) )
         {
-            auto const name = ( *iter )[ 1 ].str();
-            auto const value = ( *iter )[ 2 ].str();
-            props.insert( { name, std::stol( value ) } );
+            throw std::runtime_error( fmt::format( "Unknown property {}", name ) );
         }
 
-        objects.push_back( Object{ std::move( props ) } );
+        return iter->second;
     }
 
-    auto sum = 0L;
-    for( auto const& obj : objects )
+    Program compileWorkflows( std::istream& stream )
     {
-        fmt::print( "Checking {}\n", obj.props.at( "x" ) );
-        if( checkWorkflow( workflows, obj, "in" ) )
+        auto const PATTERN_WORKFLOW = std::regex{ R"((\w+)\{(.*),(\w+)\})" };
+        auto const PATTERN_RULE = std::regex{ R"((\w+)([<>])([-\d]+):(\w+))" };
+
+        auto program = Program{};
+        auto starts = std::unordered_map< std::string, int >{
+            { "A", ACCEPT },
+            { "R", REJECT },
+        };
+        auto targetNames = std::vector< std::string >{};
+
+        for( auto const& line : readLines( stream ) )
         {
-            for( auto const& prop : obj.props )
+            auto match = std::smatch{};
+            if( !std::regex_match( line, match, PATTERN_WORKFLOW ) )
             {
-                sum += prop.second;
+                break;
             }
-        }
-    }
 
-    return sum;
-}
+            auto const start = static_cast< int >( program.instructions.size() );
+            starts.insert( { match[ 1 ].str(), start } );
 
+            auto const ruleStr = match[ 2 ].str();
+            for( auto const& rule : iterateMatches( ruleStr, PATTERN_RULE ) )
+            {
+                program.instructions.push_back( Instruction{
+                    propIndex( rule[ 1 ].str() ),  // prop
+                    rule[ 2 ].str() == ">" ? Comparison::GREATER : Comparison::LESS,
+                    std::stol( rule[ 3 ].str() ),  // value
+                    0                              // target
+                } );
+                targetNames.push_back( rule[ 4 ].str() );
+            }
 
-namespace
-{
-    bool checkWorkflow( std::unordered_map< std::string, Workflow > const& workflows,
-                        Object const& obj,
-                        std::string const& name )
-    {
-        fmt::print( "WF: {}\n", name );
-        if( name == "A" )
-        {
-            return true;
+            program.instructions.push_back( Instruction{ 0, Comparison::ALWAYS, 0, 0 } );
+            targetNames.push_back( match[ 3 ].str() );
         }
 
-        if( name == "R" )
+        for( std::size_t i = 0; i < program.instructions.size(); ++i )
         {
-            return false;
+            program.instructions[ i ].target = starts.at( targetNames[ i ] );
         }
 
-        auto const& workflow = workflows.at( name );
+        program.entry = starts.at( "in" );
+
+        return program;
+    }
+
+    Parts loadParts( std::istream& stream )
+    {
+        auto const PATTERN_PROPS = std::regex{ R"((\w+)=([-\d]+))" };
+
+        auto parts = Parts{};
 
-        for( auto const& rule : workflow.rules )
+        for( auto const& line : readLines( stream ) )
         {
-            if( rule.op == '>' )
+            auto props = std::array< long, NUM_PROPS >{};
+
+            for( auto const& match : iterateMatches( line, PATTERN_PROPS ) )
             {
-                if( obj.props.at( rule.prop ) > rule.num )
-                {
-                    return checkWorkflow( workflows, obj, rule.target );
-                }
+                props[ propIndex( match[ 1 ].str() ) ] = std::stol( match[ 2 ].str() );
             }
-            else
+
+            for( int prop = 0; prop < NUM_PROPS; ++prop )
             {
-                if( obj.props.at( rule.prop ) < rule.num )
-                {
-                    return checkWorkflow( workflows, obj, rule.target );
-                }
+                parts.props[ prop ].push_back( props[ prop ] );
             }
         }
 
-        return checkWorkflow( workflows, obj, workflow.def );
+        return parts;
     }
 }
@@ -1,6 +1,8 @@
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fmt/format.h>
@@ -8,6 +10,7 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <numeric>
 #include <queue>
 #include <regex>
@@ -22,154 +25,421 @@
 
 namespace
 {
+    constexpr auto ACCEPT = -1;
+    constexpr auto REJECT = -2;
+
     struct Rule
     {
-        std::string prop;
-        char op;
-        long num;
-        std::string target;
+        std::size_t prop;
+        bool greater;
+        long value;
+        int target;
     };
 
     struct Workflow
     {
         std::vector< Rule > rules;
-        std::string def;
+        int def;
+    };
+
+    struct WorkflowSet
+    {
+        std::vector< Workflow > workflows;
+        int entry;
+    };
+
+    // Closed integer interval [lo, hi]
+    struct Interval
+    {
+        long lo;
+        long hi;
+
+        bool isEmpty() const
+        {
+            return lo > hi;
+        }
+    };
+
+    constexpr auto EMPTY_INTERVAL = Interval{ 1, 0 };
+
+    template < std::size_t N >
+    using Box = std::array< Interval, N >;
+
+    // Properties of the parts and the range of values each of them can take
+    struct Domain
+    {
+        std::vector< std::string > propNames;
+        std::vector< Interval > intervals;
     };
 
-    struct Object
+    // Largest number of properties supported by a domain
+    constexpr auto MAX_PROPS = 16uz;
+
+    // Partitions the accepted part of a value domain into disjoint boxes. The accepted boxes of
+    // each workflow are computed once on the full domain and reused by every workflow jumping to
+    // it, so shared sub-workflows of the DAG are only evaluated once.
+    template < std::size_t N >
+    class PartitionEngine
     {
-        std::unordered_map< std::string, long > props;
+    public:
+        PartitionEngine( WorkflowSet const& workflowSet, Box< N > const& domain );
+
+        std::vector< Box< N > > const& getAccepted( int workflow ) const;
+
+        unsigned __int128 computeVolume( int workflow ) const;
+
+    private:
+        std::vector< Box< N > > computeAccepted( Workflow const& workflow ) const;
+
+        WorkflowSet const& m_workflowSet;
+        Box< N > m_domain;
+        std::vector< Box< N > > m_none;
+        std::vector< Box< N > > m_all;
+        std::vector< std::vector< Box< N > > > m_accepted;
     };
 
-    long countAccepted( std::unordered_map< std::string, Workflow > const& workflows,
-                        std::unordered_map< std::string, std::pair< long, long > >& ranges,
-                        std::string const& name );
+    template < std::size_t N >
+    unsigned __int128 computeAcceptedVolume( WorkflowSet const& workflowSet, Domain const& domain );
+
+    // Reads an optional first line "#domain x=1..4000 m=1..4000 ..." and defaults to the four
+    // puzzle properties with values from 1 to 4000
+    Domain loadDomain( std::istream& stream );
+
+    WorkflowSet loadWorkflows( std::istream& stream, std::vector< std::string > const& propNames );
 }
 
 
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 51 },
-    { "input_final.txt", 7987 },
+    { "input_example.txt", 167409079868000 },
+    { "input_final.txt", 136146366355609 },
+    { "input_wide.txt", 48 },
 };
 
 long Application::computeResult( std::istream& inputStream )
 {
-    auto const PATTERN_WORKFLOW = std::regex{ R"((\w+)\{(.*),(\w+)\})" };
-    auto const PATTERN_RULE = std::regex{ R"((\w+)([<>])([-\d]+):(\w+))" };
-    auto const PATTERN_PROPS = std::regex{ R"((\w+)=([-\d]+))" };
+    auto const domain = loadDomain( inputStream );
+    auto const workflowSet = loadWorkflows( inputStream, domain.propNames );
+
+    auto const volume = domain.intervals.size() <= 4
+                            ? computeAcceptedVolume< 4 >( workflowSet, domain )
+                            : computeAcceptedVolume< MAX_PROPS >( workflowSet, domain );
+
+    if( volume > static_cast< unsigned __int128 >( std::numeric_limits< long >::max() ) )
+    {
+        throw std::overflow_error( "Accepted volume exceeds long" );
+    }
+
+    return static_cast< long >( volume );
+}
+
+
+namespace
+{
+    template < std::size_t N >
+    unsigned __int128 computeAcceptedVolume( WorkflowSet const& workflowSet, Domain const& domain )
+    {
+        // Unused properties get a single value, so they do not change any volume
+        auto box = Box< N >{};
+        box.fill( Interval{ 0, 0 } );
+        std::ranges::copy( domain.intervals, std::begin( box ) );
 
-    auto workflows = std::unordered_map< std::string, Workflow >{};
+        return PartitionEngine< N >{ workflowSet, box }.computeVolume( workflowSet.entry );
+    }
 
-    for( auto const& line : readLines( inputStream ) )
+    template < std::size_t N >
+    PartitionEngine< N >::PartitionEngine( WorkflowSet const& workflowSet, Box< N > const& domain )
+        : m_workflowSet{ workflowSet }
+        , m_domain{ domain }
+        , m_all{ domain }
+        , m_accepted( workflowSet.workflows.size() )
     {
-        auto match = std::smatch{};
-        if( !std::regex_match( line, match, PATTERN_WORKFLOW ) )
+        auto const& workflows = workflowSet.workflows;
+
+        // Height of each workflow in the DAG. Workflows of the same height only depend on lower
+        // ones and are processed in parallel.
+        auto heights = std::vector< int >( workflows.size(), -1 );
+
+        auto const computeHeight = [ & ]( auto const& self, int id ) -> int
         {
-            break;
-        }
+            if( id < 0 )
+            {
+                return -1;
+            }
+
+            if( heights[ id ] == -2 )
+            {
+                throw std::runtime_error( "Workflows contain a cycle" );
+            }
+
+            if( heights[ id ] < 0 )
+            {
+                heights[ id ] = -2;
+
+                auto height = self( self, workflows[ id ].def );
+                for( auto const& rule : workflows[ id ].rules )
+                {
+                    height = std::max( height, self( self, rule.target ) );
+                }
 
-        auto const name = match[ 1 ].str();
-        auto const ruleStr = match[ 2 ].str();
-        auto const def = match[ 3 ].str();
+                heights[ id ] = height + 1;
+            }
 
-        auto rules = std::vector< Rule >{};
+            return heights[ id ];
+        };
 
-        auto const begin =
-            std::sregex_iterator{ std::begin( ruleStr ), std::end( ruleStr ), PATTERN_RULE };
-        auto const end = std::sregex_iterator{};
-        for( auto iter = begin; iter != end; ++iter )
+        auto levels = std::vector< std::vector< int > >{};
+        for( std::size_t id = 0; id < workflows.size(); ++id )
         {
-            auto const prop = ( *iter )[ 1 ].str();
-            auto const op = ( *iter )[ 2 ].str();
-            auto const num = ( *iter )[ 3 ].str();
-            auto const target = ( *iter )[ 4 ].str();
+            auto const height = static_cast< std::size_t >(
+                computeHeight( computeHeight, static_cast< int >( id ) ) );
+            if( levels.size() <= height )
+            {
+                levels.resize( height + 1 );
+            }
+            levels[ height ].push_back( static_cast< int >( id ) );
+        }
 
-            rules.push_back( Rule{ prop, op[ 0 ], std::stol( num ), target } );
+        for( auto const& level : levels )
+        {
+#pragma omp parallel for
+            for( std::size_t i = 0; i < level.size(); ++i )
+            {
+                m_accepted[ level[ i ] ] = computeAccepted( workflows[ level[ i ] ] );
+            }
         }
+    }
 
-        workflows.insert( { name, Workflow{ std::move( rules ), def } } );
+    template < std::size_t N >
+    std::vector< Box< N > > const& PartitionEngine< N >::getAccepted( int workflow ) const
+    {
+        switch( workflow )
+        {
+            case ACCEPT:
+                return m_all;
+            case REJECT:
+                return m_none;
+            default:
+                return m_accepted[ workflow ];
+        }
     }
 
-    auto objects = std::vector< Object >{};
-    for( auto const& line : readLines( inputStream ) )
+    template < std::size_t N >
+    unsigned __int128 PartitionEngine< N >::computeVolume( int workflow ) const
     {
-        auto props = std::unordered_map< std::string, long >{};
+        auto volume = static_cast< unsigned __int128 >( 0 );
 
-        auto const begin =
-            std::sregex_iterator{ std::begin( line ), std::end( line ), PATTERN_PROPS };
-        auto const end = std::sregex_iterator{};
-        for( auto iter = begin; iter != end; ++iter )
+        for( auto const& box : getAccepted( workflow ) )
         {
-            auto const name = ( *iter )[ 1 ].str();
-            auto const value = ( *iter )[ 2 ].str();
-            props.insert( { name, std::stol( value ) } );
+            auto boxVolume = static_cast< unsigned __int128 >( 1 );
+            for( auto const& interval : box )
+            {
+                // Computed in 128 bits, the full range of long has 2^64 values
+                auto const width = static_cast< unsigned __int128 >(
+                    static_cast< __int128 >( interval.hi ) - interval.lo + 1 );
+
+                if( __builtin_mul_overflow( boxVolume, width, &boxVolume ) )
+                {
+                    throw std::overflow_error( "Box volume exceeds 128 bits" );
+                }
+            }
+
+            if( __builtin_add_overflow( volume, boxVolume, &volume ) )
+            {
+                throw std::overflow_error( "Accepted volume exceeds 128 bits" );
+            }
         }
 
-        objects.push_back( Object{ std::move( props ) } );
+        return volume;
     }
 
-    auto ranges = std::unordered_map< std::string, std::pair< long, long > >{
-        { "x", { 1, 4000 } },
-        { "m", { 1, 4000 } },
-        { "a", { 1, 4000 } },
-        { "s", { 1, 4000 } },
-    };
+    template < std::size_t N >
+    std::vector< Box< N > > PartitionEngine< N >::computeAccepted( Workflow const& workflow ) const
+    {
+        auto accepted = std::vector< Box< N > >{};
 
-    return countAccepted( workflows, ranges, "in" );
-}
+        // Part of the domain that did not match any of the previous rules
+        auto remaining = m_domain;
 
+        auto const addMatching = [ & ]( Box< N > const& matching, int target )
+        {
+            for( auto box : getAccepted( target ) )
+            {
+                auto isEmpty = false;
+                for( std::size_t prop = 0; prop < N; ++prop )
+                {
+                    box[ prop ].lo = std::max( box[ prop ].lo, matching[ prop ].lo );
+                    box[ prop ].hi = std::min( box[ prop ].hi, matching[ prop ].hi );
+                    isEmpty |= box[ prop ].isEmpty();
+                }
 
-namespace
-{
-    long countAccepted( std::unordered_map< std::string, Workflow > const& workflows,
-                        std::unordered_map< std::string, std::pair< long, long > >& ranges,
-                        std::string const& name )
+                if( !isEmpty )
+                {
+                    accepted.push_back( box );
+                }
+            }
+        };
+
+        for( auto const& rule : workflow.rules )
+        {
+            auto matching = remaining;
+            auto& matchingInterval = matching[ rule.prop ];
+            auto& remainingInterval = remaining[ rule.prop ];
+
+            // Nothing lies beyond the limits of long, so those comparisons never match
+            if( rule.greater )
+            {
+                if( rule.value == std::numeric_limits< long >::max() )
+                {
+                    matchingInterval = EMPTY_INTERVAL;
+                }
+                else
+                {
+                    matchingInterval.lo = std::max( matchingInterval.lo, rule.value + 1 );
+                }
+                remainingInterval.hi = std::min( remainingInterval.hi, rule.value );
+            }
+            else
+            {
+                if( rule.value == std::numeric_limits< long >::min() )
+                {
+                    matchingInterval = EMPTY_INTERVAL;
+                }
+                else
+                {
+                    matchingInterval.hi = std::min( matchingInterval.hi, rule.value - 1 );
+                }
+                remainingInterval.lo = std::max( remainingInterval.lo, rule.value );
+            }
+
+            if( !matchingInterval.isEmpty() )
+            {
+                addMatching( matching, rule.target );
+            }
+
+            if( remainingInterval.isEmpty() )
+            {
+                return accepted;
+            }
+        }
+
+        addMatching( remaining, workflow.def );
+
+        return accepted;
+    }
+
+    Domain loadDomain( std::istream& stream )
     {
-        if( name == "A" )
+        if( stream.peek() != '#' )
         {
-            auto sum = 1L;
-            for( auto range : ranges )
+            auto const interval = Interval{ 1, 4000 };
+            return { { "x", "m", "a", "s" }, { interval, interval, interval, interval } };
+        }
+
+        auto const PATTERN_DOMAIN = std::regex{ R"(#domain(\s+\w+=-?\d+\.\.-?\d+)+)" };
+        auto const PATTERN_PROP = std::regex{ R"((\w+)=(-?\d+)\.\.(-?\d+))" };
+
+        auto line = std::string{};
+        std::getline( stream, line );
+
+        if( !std::regex_match( line, PATTERN_DOMAIN ) )
+        {
+            throw std::runtime_error( fmt::format( "Invalid domain: {}", line ) );
+        }
+
+        auto domain = Domain{};
+        for( auto const& prop : iterateMatches( line, PATTERN_PROP ) )
+        {
+            auto const interval = Interval{
+                std::stol( prop[ 2 ].str() ),  // lo
+                std::stol( prop[ 3 ].str() ),  // hi
+            };
+            if( interval.isEmpty() )
             {
-                sum *= std::max( 0L, range.second.second - range.second.first + 1 );
+                throw std::runtime_error( fmt::format( "Empty domain of {}", prop[ 1 ].str() ) );
             }
-            return sum;
+
+            domain.propNames.push_back( prop[ 1 ].str() );
+            domain.intervals.push_back( interval );
         }
 
-        if( name == "R" )
+        if( domain.intervals.size() > MAX_PROPS )
         {
-            return 0L;
+            throw std::runtime_error(
+                fmt::format( "Domain has more than {} properties", MAX_PROPS ) );
         }
 
-        auto const& workflow = workflows.at( name );
+        return domain;
+    }
 
-        auto myRanges = ranges;
+    WorkflowSet loadWorkflows( std::istream& stream, std::vector< std::string > const& propNames )
+    {
+        auto const PATTERN_WORKFLOW = std::regex{ R"((\w+)\{(.*),(\w+)\})" };
+        auto const PATTERN_RULE = std::regex{ R"((\w+)([<>])([-\d]+):(\w+))" };
 
-        auto sum = 0L;
-        for( auto const& rule : workflow.rules )
+        struct NamedRules
+        {
+            std::vector< std::pair< Rule, std::string > > rules;
+            std::string def;
+        };
+
+        auto ids = std::unordered_map< std::string, int >{
+            { "A", ACCEPT },
+            { "R", REJECT },
+        };
+        auto namedWorkflows = std::vector< NamedRules >{};
+
+        auto const getProp = [ & ]( std::string const& name )
         {
-            auto& propRange = myRanges.at( rule.prop );
-            if( rule.op == '>' )
+            auto const iter = std::ranges::find( propNames, name );
+            if( iter == std::end( propNames ) )
             {
-                auto const oldVal = propRange.first;
-                propRange.first = std::max( rule.num + 1, oldVal );
-                sum += countAccepted( workflows, myRanges, rule.target );
-                propRange.first = oldVal;
-                propRange.second = rule.num;
+                throw std::runtime_error( fmt::format( "Unknown property {}", name ) );
             }
-            else
+            return static_cast< std::size_t >( iter - std::begin( propNames ) );
+        };
+
+        for( auto const& line : readLines( stream ) )
+        {
+            auto match = std::smatch{};
+            if( !std::regex_match( line, match, PATTERN_WORKFLOW ) )
+            {
+                break;
+            }
+
+            ids.insert( { match[ 1 ].str(), static_cast< int >( namedWorkflows.size() ) } );
+
+            auto workflow = NamedRules{ {}, match[ 3 ].str() };
+            auto const ruleStr = match[ 2 ].str();
+            for( auto const& rule : iterateMatches( ruleStr, PATTERN_RULE ) )
+            {
+                workflow.rules.emplace_back(
+                    Rule{ getProp( rule[ 1 ].str() ),    // prop
+                          rule[ 2 ].str() == ">",        // greater
+                          std::stol( rule[ 3 ].str() ),  // value
+                          0 },                           // target
+                    rule[ 4 ].str() );
+            }
+
+            namedWorkflows.push_back( std::move( workflow ) );
+        }
+
+        auto workflowSet = WorkflowSet{};
+
+        for( auto const& named : namedWorkflows )
+        {
+            auto workflow = Workflow{ {}, ids.at( named.def ) };
+            for( auto [ rule, target ] : named.rules )
             {
-                auto const oldVal = propRange.second;
-                propRange.second = std::min( rule.num - 1, oldVal );
-                sum += countAccepted( workflows, myRanges, rule.target );
-                propRange.second = oldVal;
-                propRange.first = rule.num;
+                rule.target = ids.at( target );
+                workflow.rules.push_back( rule );
             }
+            workflowSet.workflows.push_back( std::move( workflow ) );
         }
 
-        sum += countAccepted( workflows, myRanges, workflow.def );
+        workflowSet.entry = ids.at( "in" );
 
-        return sum;
+        return workflowSet;
     }
 }
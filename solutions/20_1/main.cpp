@@ -1,6 +1,8 @@
 #include <algorithm>
+#include <bit>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <fmt/core.h>
 #include <fmt/format.h>
@@ -22,276 +24,334 @@
 
 namespace
 {
-    class Module;
+    using ModuleId = std::uint16_t;
 
-    enum class PulseType
+    enum class ModuleType : std::uint8_t
     {
-        HIGH,
-        LOW,
+        BROADCASTER,
+        FLIP_FLOP,
+        CONJUNCTION,
+        UNTYPED,
     };
 
-    struct PulseInput
+    // Module network in structure-of-arrays form. Module ids are dense and outputs are stored as
+    // one contiguous edge list with per-module offsets.
+    struct Network
     {
-        Module* source;
-        Module* target;
-        PulseType type;
-    };
+        std::vector< std::string > names;
+        std::vector< ModuleType > types;
 
-    struct Context
-    {
-        std::unordered_map< std::string, std::unique_ptr< Module > > modules;
-        std::queue< PulseInput > pulseQueue;
-    };
+        // Outputs of module i are edges outputBegin[ i ] to outputBegin[ i + 1 ]
+        std::vector< std::uint32_t > outputBegin;
+        std::vector< ModuleId > outputTargets;
 
-    class Module
-    {
-    public:
-        static std::unique_ptr< Module > load( std::string const& name );
+        // Index of the edge within the inputs of its target (bit in the conjunction memory)
+        std::vector< std::uint8_t > outputSlots;
 
-        Module( std::string name ) : m_name{ std::move( name ) }
-        {
-        }
+        std::vector< std::uint8_t > inputCounts;
 
-        virtual ~Module() = default;
+        ModuleId broadcaster;
 
-        std::string const& getName() const
+        std::size_t size() const
         {
-            return m_name;
+            return types.size();
         }
-
-        virtual void addInput( Module* mod )
-        {
-            m_inputs.push_back( mod );
-        }
-
-        void addOutput( Module* mod )
-        {
-            m_outputs.push_back( mod );
-        }
-
-        virtual void processPulse( PulseInput const& input, Context& context ) = 0;
-
-    protected:
-        std::string m_name;
-        std::vector< Module* > m_inputs;
-        std::vector< Module* > m_outputs;
     };
 
-    class Broadcaster : public Module
+    struct Pulse
     {
-    public:
-        Broadcaster( std::string name ) : Module{ std::move( name ) }
-        {
-        }
-
-        virtual void processPulse( PulseInput const& input, Context& context ) override
-        {
-            for( auto const output : m_outputs )
-            {
-                context.pulseQueue.push( PulseInput{ this, output, input.type } );
-            }
-        }
+        ModuleId target;
+        std::uint8_t slot;
+        bool high;
     };
 
-    class FlipFlop : public Module
+    // Fixed capacity FIFO of pulses. The capacity is a power of two so that wrapping is a mask.
+    class PulseQueue
     {
     public:
-        FlipFlop( std::string name ) : Module{ std::move( name ) }
+        explicit PulseQueue( std::size_t minCapacity );
+
+        bool empty() const
         {
+            return m_head == m_tail;
         }
 
-        virtual void processPulse( PulseInput const& input, Context& context ) override
+        void push( Pulse const& pulse )
         {
-            if( input.type == PulseType::HIGH )
+            if( m_tail - m_head == m_buffer.size() )
             {
-                return;
+                grow();
             }
 
-            m_isOn = !m_isOn;
-
-            for( auto const output : m_outputs )
-            {
-                context.pulseQueue.push(
-                    PulseInput{ this, output, m_isOn ? PulseType::HIGH : PulseType::LOW } );
-            }
+            m_buffer[ m_tail++ & m_mask ] = pulse;
         }
 
-    private:
-        bool m_isOn = false;
-    };
-
-    class Conjunction : public Module
-    {
-    public:
-        Conjunction( std::string name ) : Module{ std::move( name ) }
+        Pulse pop()
         {
+            return m_buffer[ m_head++ & m_mask ];
         }
 
-        virtual void processPulse( PulseInput const& input, Context& context ) override
-        {
-            m_lastPulse.insert_or_assign( input.source, input.type );
+    private:
+        void grow();
 
-            auto allHigh = true;
+        std::vector< Pulse > m_buffer;
+        std::size_t m_mask;
+        std::size_t m_head{ 0 };
+        std::size_t m_tail{ 0 };
+    };
 
-            for( auto const input : m_inputs )
-            {
-                auto const iter = m_lastPulse.find( input );
-                auto const lastPulse =
-                    iter == std::end( m_lastPulse ) ? PulseType::LOW : iter->second;
+    struct PulseCount
+    {
+        long low{ 0 };
+        long high{ 0 };
+    };
 
-                if( lastPulse == PulseType::LOW )
-                {
-                    allHigh = false;
-                    break;
-                }
-            }
+    class Simulator
+    {
+    public:
+        explicit Simulator( Network const& network );
 
-            for( auto const output : m_outputs )
-            {
-                context.pulseQueue.push(
-                    PulseInput{ this, output, allHigh ? PulseType::LOW : PulseType::HIGH } );
-            }
-        }
+        PulseCount pressButton();
 
     private:
-        std::unordered_map< Module*, PulseType > m_lastPulse;
-    };
+        Network const& m_network;
 
-    class Untyped : public Module
-    {
-    public:
-        Untyped( std::string name ) : Module{ std::move( name ) }
-        {
-        }
+        // One bit per module id
+        std::vector< std::uint64_t > m_flipFlops;
 
-        virtual void processPulse( PulseInput const& input, Context& context ) override
-        {
-            // Do nothing
-        }
+        // Last pulse per input slot of a conjunction and the number of set bits
+        std::vector< std::uint64_t > m_memory;
+        std::vector< std::uint8_t > m_highInputs;
+
+        PulseQueue m_queue;
     };
 
-    Context load( std::istream& stream );
+    Network load( std::istream& stream );
 }
 
 
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 51 },
-    { "input_final.txt", 7987 },
+    { "input_example_1.txt", 32000000 },
+    { "input_example_2.txt", 11687500 },
+    { "input_final.txt", 869395600 },
 };
 
 long Application::computeResult( std::istream& inputStream )
 {
-    auto context = load( inputStream );
+    auto const network = load( inputStream );
+    auto simulator = Simulator{ network };
 
-    auto highCount = 0L;
-    auto lowCount = 0L;
+    auto total = PulseCount{};
 
     for( int i = 0; i < 1000; ++i )
     {
-        context.pulseQueue.push( PulseInput{
-            nullptr,                                    // source
-            context.modules.at( "broadcaster" ).get(),  // target
-            PulseType::LOW                              // type
-        } );
+        auto const count = simulator.pressButton();
+        total.low += count.low;
+        total.high += count.high;
+    }
+
+    return total.high * total.low;
+}
+
+
+namespace
+{
+    PulseQueue::PulseQueue( std::size_t minCapacity )
+        : m_buffer( std::bit_ceil( std::max( minCapacity, 1uz ) ) ), m_mask{ m_buffer.size() - 1 }
+    {
+    }
 
+    void PulseQueue::grow()
+    {
+        auto buffer = std::vector< Pulse >( m_buffer.size() * 2 );
 
-        while( !context.pulseQueue.empty() )
+        for( auto i = m_head; i != m_tail; ++i )
         {
-            auto const input = context.pulseQueue.front();
-            context.pulseQueue.pop();
+            buffer[ i - m_head ] = m_buffer[ i & m_mask ];
+        }
+
+        m_tail -= m_head;
+        m_head = 0;
+        m_buffer = std::move( buffer );
+        m_mask = m_buffer.size() - 1;
+    }
+
+    Simulator::Simulator( Network const& network )
+        : m_network{ network }
+        , m_flipFlops( ( network.size() + 63 ) / 64, 0 )
+        , m_memory( network.size(), 0 )
+        , m_highInputs( network.size(), 0 )
+        , m_queue{ network.outputTargets.size() * 2 }
+    {
+    }
+
+    PulseCount Simulator::pressButton()
+    {
+        auto const& net = m_network;
+        auto count = PulseCount{};
 
-            // fmt::print( "Processing {} {} {}\n",
-            //             input.source == nullptr ? "Button" : input.source->getName(),
-            //             input.target->getName(),
-            //             input.type == PulseType::HIGH ? "high" : "low" );
+        m_queue.push( Pulse{ net.broadcaster, 0, false } );
 
-            input.target->processPulse( input, context );
+        while( !m_queue.empty() )
+        {
+            auto const pulse = m_queue.pop();
+            auto const id = pulse.target;
+
+            ++( pulse.high ? count.high : count.low );
 
-            if( input.type == PulseType::HIGH )
+            auto output = false;
+
+            switch( net.types[ id ] )
             {
-                ++highCount;
+                case ModuleType::BROADCASTER:
+                    output = pulse.high;
+                    break;
+
+                case ModuleType::FLIP_FLOP:
+                {
+                    if( pulse.high )
+                    {
+                        continue;
+                    }
+
+                    auto& word = m_flipFlops[ id / 64 ];
+                    word ^= std::uint64_t{ 1 } << ( id % 64 );
+                    output = ( word >> ( id % 64 ) ) & 1;
+                    break;
+                }
+
+                case ModuleType::CONJUNCTION:
+                {
+                    auto& memory = m_memory[ id ];
+                    auto const bit = std::uint64_t{ 1 } << pulse.slot;
+                    auto const wasHigh = ( memory & bit ) != 0;
+
+                    if( wasHigh != pulse.high )
+                    {
+                        memory ^= bit;
+                        m_highInputs[ id ] += pulse.high ? 1 : -1;
+                    }
+
+                    output = m_highInputs[ id ] != net.inputCounts[ id ];
+                    break;
+                }
+
+                case ModuleType::UNTYPED:
+                    continue;
             }
-            else
+
+            for( auto e = net.outputBegin[ id ]; e < net.outputBegin[ id + 1 ]; ++e )
             {
-                ++lowCount;
+                m_queue.push( Pulse{ net.outputTargets[ e ], net.outputSlots[ e ], output } );
             }
         }
-    }
-
-    return highCount * lowCount;
-}
 
+        return count;
+    }
 
-namespace
-{
-    Context load( std::istream& stream )
+    Network load( std::istream& stream )
     {
-        struct Connection
-        {
-            std::string source;
-            std::string target;
-        };
-
-        auto const LINE_PATTERN = std::regex{ R"(^([^\s-]+)\s*->\s*(.*)$)" };
+        auto const LINE_PATTERN = std::regex{ R"(^([%&]?)([^\s-]+)\s*->\s*(.*)$)" };
         auto const NAME_PATTERN = std::regex{ R"([^,\s]+)" };
 
-        auto context = Context{};
-        auto connections = std::vector< Connection >{};
+        auto network = Network{};
+        auto ids = std::unordered_map< std::string, ModuleId >{};
+        auto targetNames = std::vector< std::vector< std::string > >{};
 
-        for( auto const line : readLines( stream ) )
+        auto const getId = [ & ]( std::string const& name )
         {
-            auto match = std::smatch{};
-            std::regex_match( line, match, LINE_PATTERN );
-            auto mod = Module::load( match[ 1 ].str() );
-            auto const targetNames = match[ 2 ].str();
+            auto const [ iter, inserted ] =
+                ids.try_emplace( name, static_cast< ModuleId >( network.names.size() ) );
 
-            for( auto const& targetMatch : iterateMatches( targetNames, NAME_PATTERN ) )
+            if( inserted )
             {
-                connections.push_back( Connection{ mod->getName(), targetMatch.str() } );
+                network.names.push_back( name );
+                network.types.push_back( ModuleType::UNTYPED );
             }
 
-            auto const modName = mod->getName();
-            context.modules.insert( { modName, std::move( mod ) } );
-        }
+            return iter->second;
+        };
 
-        for( auto const& conn : connections )
+        for( auto const& line : readLines( stream ) )
         {
-            auto const& source = context.modules.at( conn.source );
-            auto const targetIter = context.modules.find( conn.target );
+            auto match = std::smatch{};
+            if( !std::regex_match( line, match, LINE_PATTERN ) )
+            {
+                throw std::runtime_error( fmt::format( "Invalid line: {}", line ) );
+            }
 
-            if( targetIter == std::end( context.modules ) )
+            auto const prefix = match[ 1 ].str();
+            auto const name = match[ 2 ].str();
+            auto const id = getId( name );
+            targetNames.resize( network.size() );
+
+            if( prefix == "%" )
+            {
+                network.types[ id ] = ModuleType::FLIP_FLOP;
+            }
+            else if( prefix == "&" )
+            {
+                network.types[ id ] = ModuleType::CONJUNCTION;
+            }
+            else if( name == "broadcaster" )
+            {
+                network.types[ id ] = ModuleType::BROADCASTER;
+            }
+            else
             {
-                auto mod = std::make_unique< Untyped >( conn.target );
-                context.modules.insert( { conn.target, std::move( mod ) } );
+                throw std::runtime_error( fmt::format( "Unknown module type {}", name ) );
             }
-            auto const& target = context.modules.at( conn.target );
 
-            source->addOutput( target.get() );
-            target->addInput( source.get() );
+            auto const targets = match[ 3 ].str();
+            for( auto const& targetMatch : iterateMatches( targets, NAME_PATTERN ) )
+            {
+                targetNames[ id ].push_back( targetMatch.str() );
+            }
         }
 
-        return context;
-    }
-
-    std::unique_ptr< Module > Module::load( std::string const& name )
-    {
-        if( name == "broadcaster" )
+        // Assigns IDs to modules that only appear as targets. They do not have targets of their
+        // own, so targetNames is only extended once all of them are known.
+        for( auto const& names : targetNames )
         {
-            return std::make_unique< Broadcaster >( name );
+            for( auto const& targetName : names )
+            {
+                getId( targetName );
+            }
         }
+        targetNames.resize( network.size() );
 
-        if( name[ 0 ] == '%' )
+        if( network.size() > std::numeric_limits< ModuleId >::max() )
         {
-            return std::make_unique< FlipFlop >( name.substr( 1 ) );
+            throw std::runtime_error( "Too many modules" );
         }
 
-        if( name[ 0 ] == '&' )
+        network.inputCounts.assign( network.size(), 0 );
+        network.outputBegin.push_back( 0 );
+
+        for( std::size_t id = 0; id < network.size(); ++id )
         {
-            return std::make_unique< Conjunction >( name.substr( 1 ) );
+            for( auto const& targetName : targetNames[ id ] )
+            {
+                auto const target = ids.at( targetName );
+                auto const slot = network.inputCounts[ target ]++;
+
+                if( slot >= 64 )
+                {
+                    throw std::runtime_error(
+                        fmt::format( "Module {} has more than 64 inputs", targetName ) );
+                }
+
+                network.outputTargets.push_back( target );
+                network.outputSlots.push_back( slot );
+            }
+
+            network.outputBegin.push_back( network.outputTargets.size() );
         }
 
-        throw std::runtime_error( fmt::format( "Unknown module type {}", name ) );
+        network.broadcaster = ids.at( "broadcaster" );
+
+        return network;
     }
 }
@@ -0,0 +1,563 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <queue>
+#include <regex>
+#include <set>
+#include <thread>
+#include <unordered_set>
+
+#include <omp.h>
+
+#include <utils.hpp>
+
+
+namespace
+{
+    using ModuleId = std::uint16_t;
+
+    enum class ModuleType : std::uint8_t
+    {
+        BROADCASTER,
+        FLIP_FLOP,
+        CONJUNCTION,
+        UNTYPED,
+    };
+
+    // Module network in structure-of-arrays form. Module ids are dense and outputs are stored as
+    // one contiguous edge list with per-module offsets.
+    struct Network
+    {
+        std::vector< std::string > names;
+        std::vector< ModuleType > types;
+
+        // Outputs of module i are edges outputBegin[ i ] to outputBegin[ i + 1 ]
+        std::vector< std::uint32_t > outputBegin;
+        std::vector< ModuleId > outputTargets;
+
+        // Index of the edge within the inputs of its target (bit in the conjunction memory)
+        std::vector< std::uint8_t > outputSlots;
+
+        std::vector< std::uint8_t > inputCounts;
+
+        ModuleId broadcaster;
+
+        std::size_t size() const
+        {
+            return types.size();
+        }
+    };
+
+    struct Pulse
+    {
+        ModuleId target;
+        std::uint8_t slot;
+        bool high;
+    };
+
+    // Fixed capacity FIFO of pulses. The capacity is a power of two so that wrapping is a mask.
+    class PulseQueue
+    {
+    public:
+        explicit PulseQueue( std::size_t minCapacity );
+
+        bool empty() const
+        {
+            return m_head == m_tail;
+        }
+
+        void push( Pulse const& pulse )
+        {
+            if( m_tail - m_head == m_buffer.size() )
+            {
+                grow();
+            }
+
+            m_buffer[ m_tail++ & m_mask ] = pulse;
+        }
+
+        Pulse pop()
+        {
+            return m_buffer[ m_head++ & m_mask ];
+        }
+
+    private:
+        void grow();
+
+        std::vector< Pulse > m_buffer;
+        std::size_t m_mask;
+        std::size_t m_head{ 0 };
+        std::size_t m_tail{ 0 };
+    };
+
+    class Simulator
+    {
+    public:
+        explicit Simulator( Network const& network );
+
+        // Injects the pulse and processes all resulting pulses. Returns whether the watched module
+        // sent a high pulse in the process.
+        bool pressButton( Pulse const& injected, ModuleId watched );
+
+    private:
+        Network const& m_network;
+
+        // One bit per module id
+        std::vector< std::uint64_t > m_flipFlops;
+
+        // Last pulse per input slot of a conjunction and the number of set bits
+        std::vector< std::uint64_t > m_memory;
+        std::vector< std::uint8_t > m_highInputs;
+
+        PulseQueue m_queue;
+    };
+
+    // Part of the network that is fed by a single broadcaster output and drives a single input of
+    // the final conjunction
+    struct SubCircuit
+    {
+        std::uint32_t entryEdge;
+        ModuleId output;
+        std::size_t size;
+        long firstHigh;
+        long period;
+    };
+
+    ModuleId findModule( Network const& network, std::string const& name );
+
+    std::vector< ModuleId > findInputs( Network const& network, ModuleId id );
+
+    std::vector< SubCircuit > findSubCircuits( Network const& network, ModuleId finalConjunction );
+
+    void findPeriod( Network const& network, SubCircuit& circuit );
+
+    Network load( std::istream& stream );
+}
+
+
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
+
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_final.txt", 232605773145467 },
+};
+
+long Application::computeResult( std::istream& inputStream )
+{
+    auto const network = load( inputStream );
+
+    auto const rxInputs = findInputs( network, findModule( network, "rx" ) );
+    if( rxInputs.size() != 1 || network.types[ rxInputs[ 0 ] ] != ModuleType::CONJUNCTION )
+    {
+        throw std::runtime_error( "rx is not driven by a single conjunction" );
+    }
+
+    auto const finalConjunction = rxInputs[ 0 ];
+    auto circuits = findSubCircuits( network, finalConjunction );
+
+    // Exceptions must not leave the parallel region
+    auto error = std::exception_ptr{};
+
+#pragma omp parallel for
+    for( std::size_t i = 0; i < circuits.size(); ++i )
+    {
+        try
+        {
+            findPeriod( network, circuits[ i ] );
+        }
+        catch( ... )
+        {
+#pragma omp critical
+            error = std::current_exception();
+        }
+    }
+
+    if( error )
+    {
+        std::rethrow_exception( error );
+    }
+
+    auto combined = Congruence{ 0, 1 };
+    auto earliest = 0L;
+
+    for( auto const& circuit : circuits )
+    {
+        fmt::print( "Sub-circuit {} -> {}: {} modules, first high at press {}, period {}\n",
+                    network.names[ network.outputTargets[ circuit.entryEdge ] ],
+                    network.names[ circuit.output ],
+                    circuit.size,
+                    circuit.firstHigh,
+                    circuit.period );
+
+        combined = combineCongruences(
+            combined, Congruence{ circuit.firstHigh % circuit.period, circuit.period } );
+        earliest = std::max( earliest, circuit.firstHigh );
+    }
+
+    auto presses = combined.remainder;
+    while( presses < earliest )
+    {
+        if( __builtin_add_overflow( presses, combined.modulus, &presses ) )
+        {
+            throw std::overflow_error( "Number of button presses exceeds long" );
+        }
+    }
+
+    fmt::print( "{} sub-circuits into {}, combined period {}, offset {}\n",
+                circuits.size(),
+                network.names[ finalConjunction ],
+                combined.modulus,
+                combined.remainder );
+
+    return presses;
+}
+
+
+namespace
+{
+    PulseQueue::PulseQueue( std::size_t minCapacity )
+        : m_buffer( std::bit_ceil( std::max( minCapacity, 1uz ) ) ), m_mask{ m_buffer.size() - 1 }
+    {
+    }
+
+    void PulseQueue::grow()
+    {
+        auto buffer = std::vector< Pulse >( m_buffer.size() * 2 );
+
+        for( auto i = m_head; i != m_tail; ++i )
+        {
+            buffer[ i - m_head ] = m_buffer[ i & m_mask ];
+        }
+
+        m_tail -= m_head;
+        m_head = 0;
+        m_buffer = std::move( buffer );
+        m_mask = m_buffer.size() - 1;
+    }
+
+    Simulator::Simulator( Network const& network )
+        : m_network{ network }
+        , m_flipFlops( ( network.size() + 63 ) / 64, 0 )
+        , m_memory( network.size(), 0 )
+        , m_highInputs( network.size(), 0 )
+        , m_queue{ network.outputTargets.size() * 2 }
+    {
+    }
+
+    bool Simulator::pressButton( Pulse const& injected, ModuleId watched )
+    {
+        auto const& net = m_network;
+        auto watchedHigh = false;
+
+        m_queue.push( injected );
+
+        while( !m_queue.empty() )
+        {
+            auto const pulse = m_queue.pop();
+            auto const id = pulse.target;
+
+            auto output = false;
+
+            switch( net.types[ id ] )
+            {
+                case ModuleType::BROADCASTER:
+                    output = pulse.high;
+                    break;
+
+                case ModuleType::FLIP_FLOP:
+                {
+                    if( pulse.high )
+                    {
+                        continue;
+                    }
+
+                    auto& word = m_flipFlops[ id / 64 ];
+                    word ^= std::uint64_t{ 1 } << ( id % 64 );
+                    output = ( word >> ( id % 64 ) ) & 1;
+                    break;
+                }
+
+                case ModuleType::CONJUNCTION:
+                {
+                    auto& memory = m_memory[ id ];
+                    auto const bit = std::uint64_t{ 1 } << pulse.slot;
+                    auto const wasHigh = ( memory & bit ) != 0;
+
+                    if( wasHigh != pulse.high )
+                    {
+                        memory ^= bit;
+                        m_highInputs[ id ] += pulse.high ? 1 : -1;
+                    }
+
+                    output = m_highInputs[ id ] != net.inputCounts[ id ];
+                    break;
+                }
+
+                case ModuleType::UNTYPED:
+                    continue;
+            }
+
+            watchedHigh |= id == watched && output;
+
+            for( auto e = net.outputBegin[ id ]; e < net.outputBegin[ id + 1 ]; ++e )
+            {
+                m_queue.push( Pulse{ net.outputTargets[ e ], net.outputSlots[ e ], output } );
+            }
+        }
+
+        return watchedHigh;
+    }
+
+    ModuleId findModule( Network const& network, std::string const& name )
+    {
+        auto const iter = std::ranges::find( network.names, name );
+        if( iter == std::end( network.names ) )
+        {
+            throw std::runtime_error( fmt::format( "Missing module {}", name ) );
+        }
+
+        return static_cast< ModuleId >( iter - std::begin( network.names ) );
+    }
+
+    std::vector< ModuleId > findInputs( Network const& network, ModuleId id )
+    {
+        auto inputs = std::vector< ModuleId >{};
+
+        for( std::size_t source = 0; source < network.size(); ++source )
+        {
+            auto const begin = network.outputBegin[ source ];
+            auto const end = network.outputBegin[ source + 1 ];
+
+            for( auto e = begin; e < end; ++e )
+            {
+                if( network.outputTargets[ e ] == id )
+                {
+                    inputs.push_back( static_cast< ModuleId >( source ) );
+                }
+            }
+        }
+
+        return inputs;
+    }
+
+    std::vector< SubCircuit > findSubCircuits( Network const& network, ModuleId finalConjunction )
+    {
+        constexpr auto NO_OWNER = std::numeric_limits< std::size_t >::max();
+
+        auto circuits = std::vector< SubCircuit >{};
+        auto owners = std::vector< std::size_t >( network.size(), NO_OWNER );
+
+        for( auto entryEdge = network.outputBegin[ network.broadcaster ];
+             entryEdge < network.outputBegin[ network.broadcaster + 1 ];
+             ++entryEdge )
+        {
+            auto const index = circuits.size();
+            auto circuit = SubCircuit{ entryEdge, 0, 0, 0, 0 };
+            auto outputs = std::set< ModuleId >{};
+            auto open = std::vector< ModuleId >{ network.outputTargets[ entryEdge ] };
+
+            while( !open.empty() )
+            {
+                auto const id = open.back();
+                open.pop_back();
+
+                if( owners[ id ] == index )
+                {
+                    continue;
+                }
+
+                if( owners[ id ] != NO_OWNER || id == network.broadcaster )
+                {
+                    throw std::runtime_error( fmt::format(
+                        "Module {} is shared between sub-circuits", network.names[ id ] ) );
+                }
+
+                owners[ id ] = index;
+                ++circuit.size;
+
+                for( auto e = network.outputBegin[ id ]; e < network.outputBegin[ id + 1 ]; ++e )
+                {
+                    if( network.outputTargets[ e ] == finalConjunction )
+                    {
+                        outputs.insert( id );
+                    }
+                    else
+                    {
+                        open.push_back( network.outputTargets[ e ] );
+                    }
+                }
+            }
+
+            if( outputs.size() != 1 )
+            {
+                throw std::runtime_error( fmt::format(
+                    "Sub-circuit starting at {} drives {} inputs of the final conjunction",
+                    network.names[ network.outputTargets[ entryEdge ] ],
+                    outputs.size() ) );
+            }
+
+            circuit.output = *std::begin( outputs );
+            circuits.push_back( circuit );
+        }
+
+        if( circuits.size() != network.inputCounts[ finalConjunction ] )
+        {
+            throw std::runtime_error( "Final conjunction has inputs outside of the sub-circuits" );
+        }
+
+        return circuits;
+    }
+
+    void findPeriod( Network const& network, SubCircuit& circuit )
+    {
+        constexpr auto MAX_PRESSES = 1L << 24;
+
+        auto simulator = Simulator{ network };
+        auto const injected = Pulse{ network.outputTargets[ circuit.entryEdge ],
+                                     network.outputSlots[ circuit.entryEdge ],
+                                     false };
+
+        // The third occurrence confirms that the high output repeats with a fixed period
+        auto highPresses = std::vector< long >{};
+
+        for( auto press = 1L; press <= MAX_PRESSES && highPresses.size() < 3; ++press )
+        {
+            if( simulator.pressButton( injected, circuit.output ) )
+            {
+                highPresses.push_back( press );
+            }
+        }
+
+        if( highPresses.size() < 3 )
+        {
+            throw std::runtime_error(
+                fmt::format( "No periodic high output from {} within {} presses",
+                             network.names[ circuit.output ],
+                             MAX_PRESSES ) );
+        }
+
+        circuit.firstHigh = highPresses[ 0 ];
+        circuit.period = highPresses[ 1 ] - highPresses[ 0 ];
+
+        if( highPresses[ 2 ] - highPresses[ 1 ] != circuit.period )
+        {
+            throw std::runtime_error( fmt::format( "High output from {} is not periodic: {}",
+                                                   network.names[ circuit.output ],
+                                                   highPresses ) );
+        }
+    }
+
+    Network load( std::istream& stream )
+    {
+        auto const LINE_PATTERN = std::regex{ R"(^([%&]?)([^\s-]+)\s*->\s*(.*)$)" };
+        auto const NAME_PATTERN = std::regex{ R"([^,\s]+)" };
+
+        auto network = Network{};
+        auto ids = std::unordered_map< std::string, ModuleId >{};
+        auto targetNames = std::vector< std::vector< std::string > >{};
+
+        auto const getId = [ & ]( std::string const& name )
+        {
+            auto const [ iter, inserted ] =
+                ids.try_emplace( name, static_cast< ModuleId >( network.names.size() ) );
+
+            if( inserted )
+            {
+                network.names.push_back( name );
+                network.types.push_back( ModuleType::UNTYPED );
+            }
+
+            return iter->second;
+        };
+
+        for( auto const& line : readLines( stream ) )
+        {
+            auto match = std::smatch{};
+            if( !std::regex_match( line, match, LINE_PATTERN ) )
+            {
+                throw std::runtime_error( fmt::format( "Invalid line: {}", line ) );
+            }
+
+            auto const prefix = match[ 1 ].str();
+            auto const name = match[ 2 ].str();
+            auto const id = getId( name );
+            targetNames.resize( network.size() );
+
+            if( prefix == "%" )
+            {
+                network.types[ id ] = ModuleType::FLIP_FLOP;
+            }
+            else if( prefix == "&" )
+            {
+                network.types[ id ] = ModuleType::CONJUNCTION;
+            }
+            else if( name == "broadcaster" )
+            {
+                network.types[ id ] = ModuleType::BROADCASTER;
+            }
+            else
+            {
+                throw std::runtime_error( fmt::format( "Unknown module type {}", name ) );
+            }
+
+            auto const targets = match[ 3 ].str();
+            for( auto const& targetMatch : iterateMatches( targets, NAME_PATTERN ) )
+            {
+                targetNames[ id ].push_back( targetMatch.str() );
+            }
+        }
+
+        // Assigns IDs to modules that only appear as targets. They do not have targets of their
+        // own, so targetNames is only extended once all of them are known.
+        for( auto const& names : targetNames )
+        {
+            for( auto const& targetName : names )
+            {
+                getId( targetName );
+            }
+        }
+        targetNames.resize( network.size() );
+
+        if( network.size() > std::numeric_limits< ModuleId >::max() )
+        {
+            throw std::runtime_error( "Too many modules" );
+        }
+
+        network.inputCounts.assign( network.size(), 0 );
+        network.outputBegin.push_back( 0 );
+
+        for( std::size_t id = 0; id < network.size(); ++id )
+        {
+            for( auto const& targetName : targetNames[ id ] )
+            {
+                auto const target = ids.at( targetName );
+                auto const slot = network.inputCounts[ target ]++;
+
+                if( slot >= 64 )
+                {
+                    throw std::runtime_error(
+                        fmt::format( "Module {} has more than 64 inputs", targetName ) );
+                }
+
+                network.outputTargets.push_back( target );
+                network.outputSlots.push_back( slot );
+            }
+
+            network.outputBegin.push_back( network.outputTargets.size() );
+        }
+
+        network.broadcaster = ids.at( "broadcaster" );
+
+        return network;
+    }
+}
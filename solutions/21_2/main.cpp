@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fmt/core.h>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <queue>
+#include <regex>
+#include <set>
+#include <thread>
+#include <unordered_set>
+
+#include <omp.h>
+
+#include <utils.hpp>
+
+
+namespace
+{
+    // Default number of steps, the first argument overrides it
+    constexpr auto STEPS = 26501365L;
+
+    // Number of consecutive periods with an identical second difference before the growth is
+    // considered to be quadratic
+    constexpr auto STABLE_PERIODS = 3L;
+
+    // Number of additional periods that are simulated directly to cross-check the extrapolation
+    // (0 disables the validation)
+    constexpr auto VALIDATION_PERIODS = 2L;
+
+    // Upper bound on the number of simulated periods before giving up on the extrapolation
+    constexpr auto MAX_PERIODS = 200L;
+
+    struct Pos
+    {
+        long x;
+        long y;
+
+        bool operator==( Pos const& rhs ) const
+        {
+            return x == rhs.x && y == rhs.y;
+        }
+    };
+
+    Pos findStart( Grid< char > const& grid );
+}
+
+template <>
+struct std::hash< Pos >
+{
+    std::size_t operator()( Pos const& pos ) const noexcept
+    {
+        auto hasher = HashComputer{};
+        hasher.push( pos.x );
+        hasher.push( pos.y );
+        return hasher.getValue();
+    }
+};
+
+namespace
+{
+    // Counts the plots reachable on the infinitely repeated garden. The repetition is resolved on
+    // the fly by wrapping coordinates into the original grid.
+    class StepCounter
+    {
+    public:
+        StepCounter( Grid< char > const& grid, Pos start );
+
+        // Number of plots reachable in exactly `steps` steps by direct simulation
+        long countDirect( long steps );
+
+        // Number of plots reachable in exactly `steps` steps. Samples taken one grid period apart
+        // are simulated until their second difference becomes constant, i.e. until the tiles on
+        // the frontier are filled periodically. The quadratic growth is then extrapolated.
+        long countExtrapolated( long steps );
+
+    private:
+        bool isGarden( Pos const& pos ) const;
+
+        void advance();
+
+        Grid< char > const& m_grid;
+        long m_period;
+
+        // Breadth-first layers of the last two distances. The garden is bipartite, so neighbors
+        // of the current layer are either in the previous or in the next one.
+        std::unordered_set< Pos > m_previous;
+        std::unordered_set< Pos > m_current;
+
+        // Number of plots reachable in exactly i steps
+        std::vector< long > m_reachable;
+    };
+}
+
+
+std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
+
+ExpectedResults Application::EXPECTED_RESULTS = {
+    { "input_example_1.txt", 470149643712804 },
+    { "input_example_1.txt 6", 16 },
+    { "input_example_1.txt 50", 1594 },
+    { "input_example_1.txt 500", 167004 },
+    { "input_example_1.txt 5000", 16733044 },
+    { "input_final.txt", 597102953699891 },
+};
+
+long Application::computeResult( std::istream& inputStream )
+{
+    auto const grid = readGrid( inputStream );
+    auto counter = StepCounter{ grid, findStart( grid ) };
+    return counter.countExtrapolated( getArgument( 0, STEPS ) );
+}
+
+
+namespace
+{
+    Pos findStart( Grid< char > const& grid )
+    {
+        for( auto const [ x, y, v ] : grid.getElements() )
+        {
+            if( v == 'S' )
+            {
+                return { static_cast< long >( x ), static_cast< long >( y ) };
+            }
+        }
+
+        throw std::runtime_error( "No start" );
+    }
+
+    StepCounter::StepCounter( Grid< char > const& grid, Pos start )
+        : m_grid{ grid }
+        , m_period{ lcm( static_cast< long >( grid.getWidth() ),
+                         static_cast< long >( grid.getHeight() ) ) }
+        , m_current{ start }
+        , m_reachable{ 1 }
+    {
+    }
+
+    long StepCounter::countDirect( long steps )
+    {
+        while( static_cast< long >( m_reachable.size() ) <= steps )
+        {
+            advance();
+        }
+
+        return m_reachable[ steps ];
+    }
+
+    long StepCounter::countExtrapolated( long steps )
+    {
+        auto const remainder = steps % m_period;
+        auto const periods = steps / m_period;
+
+        auto samples = std::vector< long >{};
+        auto stableCount = 0L;
+
+        while( stableCount < STABLE_PERIODS )
+        {
+            auto const k = static_cast< long >( samples.size() );
+
+            if( k == periods )
+            {
+                return countDirect( steps );
+            }
+
+            if( k == MAX_PERIODS )
+            {
+                throw std::runtime_error(
+                    fmt::format( "Growth did not become quadratic within {} periods", k ) );
+            }
+
+            samples.push_back( countDirect( remainder + k * m_period ) );
+
+            if( k >= 3 )
+            {
+                auto const d2 = samples[ k ] - 2 * samples[ k - 1 ] + samples[ k - 2 ];
+                auto const prevD2 = samples[ k - 1 ] - 2 * samples[ k - 2 ] + samples[ k - 3 ];
+                stableCount = d2 == prevD2 ? stableCount + 1 : 0;
+            }
+        }
+
+        auto const last = static_cast< long >( samples.size() ) - 1;
+        auto const d1 = samples[ last ] - samples[ last - 1 ];
+        auto const d2 = samples[ last ] - 2 * samples[ last - 1 ] + samples[ last - 2 ];
+
+        auto const extrapolate = [ & ]( long k )
+        {
+            auto const m = static_cast< __int128 >( k - last );
+            auto const value = samples[ last ] + m * d1 + d2 * m * ( m + 1 ) / 2;
+
+            if( value > std::numeric_limits< long >::max() )
+            {
+                throw std::overflow_error(
+                    fmt::format( "Reachable plot count for {} steps exceeds long", steps ) );
+            }
+
+            return static_cast< long >( value );
+        };
+
+        for( auto k = last + 1; k <= last + VALIDATION_PERIODS && k < periods; ++k )
+        {
+            auto const expected = countDirect( remainder + k * m_period );
+            auto const actual = extrapolate( k );
+
+            if( expected != actual )
+            {
+                throw std::runtime_error(
+                    fmt::format( "Extrapolation mismatch after {} steps: simulated {}, got {}",
+                                 remainder + k * m_period,
+                                 expected,
+                                 actual ) );
+            }
+        }
+
+        return extrapolate( periods );
+    }
+
+    bool StepCounter::isGarden( Pos const& pos ) const
+    {
+        auto const width = static_cast< long >( m_grid.getWidth() );
+        auto const height = static_cast< long >( m_grid.getHeight() );
+        auto const x = ( pos.x % width + width ) % width;
+        auto const y = ( pos.y % height + height ) % height;
+        return m_grid( x, y ) != '#';
+    }
+
+    void StepCounter::advance()
+    {
+        auto next = std::unordered_set< Pos >{};
+        next.reserve( m_current.size() + 4 );
+
+        for( auto const& pos : m_current )
+        {
+            for( auto const neighbor : { Pos{ pos.x - 1, pos.y },
+                                         Pos{ pos.x + 1, pos.y },
+                                         Pos{ pos.x, pos.y - 1 },
+                                         Pos{ pos.x, pos.y + 1 } } )
+            {
+                if( isGarden( neighbor ) && !m_previous.contains( neighbor ) )
+                {
+                    next.insert( neighbor );
+                }
+            }
+        }
+
+        auto const steps = m_reachable.size();
+        auto const twoStepsBefore = steps >= 2 ? m_reachable[ steps - 2 ] : 0L;
+        m_reachable.push_back( twoStepsBefore + static_cast< long >( next.size() ) );
+
+        m_previous = std::move( m_current );
+        m_current = std::move( next );
+    }
+}
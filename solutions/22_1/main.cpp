@@ -44,8 +44,8 @@ namespace
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 51 },
-    { "input_final.txt", 7987 },
+    { "input_example_1.txt", 5 },
+    { "input_final.txt", 475 },
 };
 
 long Application::computeResult( std::istream& inputStream )
@@ -94,11 +94,13 @@ long Application::computeResult( std::istream& inputStream )
                    return lhs.min.z < rhs.min.z;
                } );
 
+    // Reused across blocks, clearing keeps the allocated slots
+    auto blocksBelow = FlatHashSet< Block* >{};
+
     for( auto& block : blocks )
     {
-        fmt::print( "Free: {} {} {}\n", block.min.x, block.min.y, block.min.z );
         auto maxZ = 0;
-        auto blocksBelow = std::unordered_set< Block* >{};
+        blocksBelow.clear();
 
         for( int x = block.min.x; x <= block.max.x; ++x )
         {
@@ -34,8 +34,8 @@ namespace
         Vec3i min;
         Vec3i max;
 
-        std::unordered_set< Block* > above;
-        std::unordered_set< Block* > below;
+        FlatHashSet< Block* > above;
+        FlatHashSet< Block* > below;
 
         static Block parse( std::string const& line );
     };
@@ -45,8 +45,8 @@ namespace
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 51 },
-    { "input_final.txt", 7987 },
+    { "input_example_1.txt", 7 },
+    { "input_final.txt", 79144 },
 };
 
 long Application::computeResult( std::istream& inputStream )
@@ -95,11 +95,13 @@ long Application::computeResult( std::istream& inputStream )
                    return lhs.min.z < rhs.min.z;
                } );
 
+    // Reused across blocks, clearing keeps the allocated slots
+    auto blocksBelow = FlatHashSet< Block* >{};
+
     for( auto& block : blocks )
     {
-        fmt::print( "Free: {} {} {}\n", block.min.x, block.min.y, block.min.z );
         auto maxZ = 0;
-        auto blocksBelow = std::unordered_set< Block* >{};
+        blocksBelow.clear();
 
         for( int x = block.min.x; x <= block.max.x; ++x )
         {
@@ -143,9 +145,10 @@ long Application::computeResult( std::istream& inputStream )
     }
 
     auto sum = 0L;
+    auto falling = FlatHashSet< Block* >{};
     for( int i = 0; i < blocks.size(); ++i )
     {
-        auto falling = std::unordered_set< Block* >{};
+        falling.clear();
         falling.insert( &blocks[ i ] );
         for( int j = i + 1; j < blocks.size(); ++j )
         {
@@ -53,8 +53,8 @@ struct std::hash< Pos >
 std::filesystem::path Application::APP_IMPL_FILE = __FILE__;
 
 ExpectedResults Application::EXPECTED_RESULTS = {
-    { "input_example.txt", 51 },
-    { "input_final.txt", 7987 },
+    { "input_example_1.txt", 94 },
+    { "input_final.txt", 2202 },
 };
 
 long Application::computeResult( std::istream& inputStream )
@@ -87,7 +87,7 @@ namespace
 {
     void computeLongestPath( Grid< char > const& grid,
                              Pos const& target,
-                             std::unordered_set< Pos >& visited,
+                             FlatHashSet< Pos >& visited,
                              std::vector< Pos >& path )
     {
         while( true )
@@ -168,7 +168,7 @@ namespace
     std::vector< Pos >
         computeLongestPath( Grid< char > const& grid, Pos const& start, Pos const& target )
     {
-        auto visited = std::unordered_set< Pos >{};
+        auto visited = FlatHashSet< Pos >{};
         auto path = std::vector< Pos >{};
 
         path.push_back( start );
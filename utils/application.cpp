@@ -1,4 +1,5 @@
 #include <application.hpp>
+#include <perf_utils.hpp>
 
 #include <fstream>
 
@@ -9,14 +10,21 @@ int main( int argc, char** argv )
 {
     if( argc < 2 )
     {
-        fmt::print( stderr, "Missing parameter: <input file>\n" );
+        fmt::print( stderr, "Missing parameter: <input file> [arguments...]\n" );
         return EXIT_FAILURE;
     }
 
     auto const inputFile = Application::APP_IMPL_FILE.parent_path() / argv[ 1 ];
     auto inputStream = std::ifstream{ inputFile };
+    Application::ARGUMENTS.assign( argv + 2, argv + argc );
 
-    auto const result = Application::computeResult( inputStream );
+    auto const result = [ & ]
+    {
+        auto perfScope = PerfScope{ "computeResult" };
+        return Application::computeResult( inputStream );
+    }();
+
+    printPerfReport();
 
     fmt::print( "Result: {}\n", result );
 
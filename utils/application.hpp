@@ -1,9 +1,12 @@
 #pragma once
 
 #include <filesystem>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 
+// Keys are the input file, optionally followed by arguments separated by spaces
 using ExpectedResults = std::unordered_map< std::string, long >;
 
 class Application
@@ -13,7 +16,24 @@ public:
 
     static ExpectedResults EXPECTED_RESULTS;
 
+    // Arguments following the input file, set by the harness before each computeResult
+    inline static std::vector< std::string > ARGUMENTS;
+
     static long computeResult( std::istream& inputStream );
 };
 
+// Argument `index` as a number, or `defaultValue` if there are not that many arguments
+long getArgument( std::size_t index, long defaultValue );
+
 int main( int argc, char** argv );
+
+
+inline long getArgument( std::size_t index, long defaultValue )
+{
+    if( index >= Application::ARGUMENTS.size() )
+    {
+        return defaultValue;
+    }
+
+    return std::stol( Application::ARGUMENTS[ index ] );
+}
@@ -1,5 +1,8 @@
 #include <application.hpp>
+#include <perf_utils.hpp>
+#include <string_utils.hpp>
 
+#include <algorithm>
 #include <fstream>
 
 #include <fmt/core.h>
@@ -7,15 +10,35 @@
 
 int main( int argc, char** argv )
 {
-    for( auto const& [ filename, expectedResult ] : Application::EXPECTED_RESULTS )
+    for( auto const& [ command, expectedResult ] : Application::EXPECTED_RESULTS )
     {
-        auto const inputFile = Application::APP_IMPL_FILE.parent_path() / filename;
+        auto arguments = split( command, ' ' );
+        std::erase_if( arguments,
+                       []( auto const& argument )
+                       {
+                           return argument.empty();
+                       } );
+
+        auto const inputFile = Application::APP_IMPL_FILE.parent_path() / arguments.front();
         auto inputStream = std::ifstream{ inputFile };
-        auto const result = Application::computeResult( inputStream );
+        Application::ARGUMENTS.assign( std::next( std::begin( arguments ) ),
+                                       std::end( arguments ) );
+
+        auto const result = [ & ]
+        {
+            auto perfScope = PerfScope{ command };
+            return Application::computeResult( inputStream );
+        }();
+
+        printPerfReport();
 
         if( result != expectedResult )
         {
-            fmt::print( stderr, "Wrong result. Got {}, expected {}.\n", result, expectedResult );
+            fmt::print( stderr,
+                        "Wrong result for {}. Got {}, expected {}.\n",
+                        command,
+                        result,
+                        expectedResult );
             return EXIT_FAILURE;
         }
     }
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include <flat_hash.hpp>
+
+
+// Sequence x_0, x_1 = step(x_0), ... that repeats with x_(i + length) = x_i for all i >= start
+struct Cycle
+{
+    long start;
+    long length;
+};
+
+// The detectors below take the initial state, a step function that advances a state in place and
+// a fingerprint function returning a 64 bit hash of a state. Fingerprints are compared first and
+// only matching fingerprints are confirmed with a full state comparison through `equal`. None of
+// them keeps more than three states alive at a time.
+
+// Brent's algorithm. Needs about start + 2 * length steps.
+template < typename TState,
+           typename TStep,
+           typename TFingerprint,
+           typename TEqual = std::equal_to< TState > >
+Cycle findCycleBrent( TState const& initial,
+                      TStep const& step,
+                      TFingerprint const& fingerprint,
+                      TEqual const& equal = {} );
+
+// Floyd's tortoise and hare. Needs about three times the steps of Brent's algorithm but only
+// compares states that are the same number of steps apart.
+template < typename TState,
+           typename TStep,
+           typename TFingerprint,
+           typename TEqual = std::equal_to< TState > >
+Cycle findCycleFloyd( TState const& initial,
+                      TStep const& step,
+                      TFingerprint const& fingerprint,
+                      TEqual const& equal = {} );
+
+// Remembers the first step each fingerprint was seen in and stops at the first repeat, so it needs
+// only start + length steps plus start more to replay the match for verification. Memory grows
+// with one entry per step instead of one state. Falls back to Brent's algorithm if two different
+// states share a fingerprint.
+template < typename TState,
+           typename TStep,
+           typename TFingerprint,
+           typename TEqual = std::equal_to< TState > >
+Cycle findCycleHashed( TState const& initial,
+                       TStep const& step,
+                       TFingerprint const& fingerprint,
+                       TEqual const& equal = {} );
+
+// Applies `step` `count` times
+template < typename TState, typename TStep >
+TState advanceState( TState state, TStep const& step, long count );
+
+// State after `index` steps. Simulates at most cycle.start + cycle.length steps.
+template < typename TState, typename TStep >
+TState getStateAt( TState const& initial, TStep const& step, Cycle const& cycle, long index );
+
+
+template < typename TState, typename TStep, typename TFingerprint, typename TEqual >
+inline Cycle findCycleBrent( TState const& initial,
+                             TStep const& step,
+                             TFingerprint const& fingerprint,
+                             TEqual const& equal )
+{
+    auto const isSame = [ & ]( TState const& lhs, TState const& rhs )
+    {
+        return fingerprint( lhs ) == fingerprint( rhs ) && equal( lhs, rhs );
+    };
+
+    // Search the length with a tortoise that jumps to the hare at every power of two
+    auto power = 1L;
+    auto length = 1L;
+    auto tortoise = initial;
+    auto hare = initial;
+    step( hare );
+
+    while( !isSame( tortoise, hare ) )
+    {
+        if( power == length )
+        {
+            tortoise = hare;
+            power *= 2;
+            length = 0;
+        }
+
+        step( hare );
+        ++length;
+    }
+
+    // With the hare `length` steps ahead both meet at the start of the cycle
+    auto start = 0L;
+    tortoise = initial;
+    hare = advanceState( initial, step, length );
+
+    while( !isSame( tortoise, hare ) )
+    {
+        step( tortoise );
+        step( hare );
+        ++start;
+    }
+
+    return { start, length };
+}
+
+template < typename TState, typename TStep, typename TFingerprint, typename TEqual >
+inline Cycle findCycleFloyd( TState const& initial,
+                             TStep const& step,
+                             TFingerprint const& fingerprint,
+                             TEqual const& equal )
+{
+    auto const isSame = [ & ]( TState const& lhs, TState const& rhs )
+    {
+        return fingerprint( lhs ) == fingerprint( rhs ) && equal( lhs, rhs );
+    };
+
+    // The hare moves twice as fast and meets the tortoise at a multiple of the length
+    auto tortoise = initial;
+    auto hare = initial;
+
+    do
+    {
+        step( tortoise );
+        step( hare );
+        step( hare );
+    } while( !isSame( tortoise, hare ) );
+
+    // Restarting the tortoise keeps that distance, so both meet again at the start of the cycle
+    auto start = 0L;
+    tortoise = initial;
+
+    while( !isSame( tortoise, hare ) )
+    {
+        step( tortoise );
+        step( hare );
+        ++start;
+    }
+
+    auto length = 1L;
+    hare = tortoise;
+    step( hare );
+
+    while( !isSame( tortoise, hare ) )
+    {
+        step( hare );
+        ++length;
+    }
+
+    return { start, length };
+}
+
+template < typename TState, typename TStep, typename TFingerprint, typename TEqual >
+inline Cycle findCycleHashed( TState const& initial,
+                              TStep const& step,
+                              TFingerprint const& fingerprint,
+                              TEqual const& equal )
+{
+    auto history = FlatHashMap< std::uint64_t, long >{};
+    auto state = initial;
+
+    for( auto index = 0L;; ++index )
+    {
+        auto const [ entry, inserted ] = history.try_emplace( fingerprint( state ), index );
+
+        if( !inserted )
+        {
+            auto const start = entry->second;
+
+            if( !equal( advanceState( initial, step, start ), state ) )
+            {
+                return findCycleBrent( initial, step, fingerprint, equal );
+            }
+
+            return { start, index - start };
+        }
+
+        step( state );
+    }
+}
+
+template < typename TState, typename TStep >
+inline TState advanceState( TState state, TStep const& step, long count )
+{
+    for( auto i = 0L; i < count; ++i )
+    {
+        step( state );
+    }
+    return state;
+}
+
+template < typename TState, typename TStep >
+inline TState getStateAt( TState const& initial, TStep const& step, Cycle const& cycle, long index )
+{
+    if( index > cycle.start )
+    {
+        index = cycle.start + ( index - cycle.start ) % cycle.length;
+    }
+    return advanceState( initial, step, index );
+}
@@ -0,0 +1,750 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+// Open addressing hash table with one metadata byte per slot. The metadata bytes are stored apart
+// from the slots and probed in groups of 16, so a lookup usually touches a single slot. Hashes
+// come from the `std::hash` specializations and are remixed, so weak hashes are fine.
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+class FlatHashTable
+{
+public:
+    using key_type = std::remove_cvref_t< decltype( TKeyOf::get( std::declval< TSlot >() ) ) >;
+    using value_type = TSlot;
+    using size_type = std::size_t;
+
+    template < bool CONST >
+    class Iterator;
+
+    using iterator = Iterator< false >;
+    using const_iterator = Iterator< true >;
+
+    FlatHashTable() = default;
+
+    FlatHashTable( FlatHashTable const& other );
+
+    FlatHashTable( FlatHashTable&& other ) noexcept;
+
+    FlatHashTable& operator=( FlatHashTable other ) noexcept;
+
+    ~FlatHashTable();
+
+    iterator begin();
+
+    iterator end();
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+    bool empty() const;
+
+    std::size_t size() const;
+
+    std::size_t capacity() const;
+
+    // Makes room for `count` elements without rehashing
+    void reserve( std::size_t count );
+
+    // Removes all elements but keeps the allocated slots
+    void clear();
+
+    iterator find( key_type const& key );
+
+    const_iterator find( key_type const& key ) const;
+
+    bool contains( key_type const& key ) const;
+
+    std::pair< iterator, bool > insert( TSlot const& value );
+
+    std::pair< iterator, bool > insert( TSlot&& value );
+
+    template < typename... TArgs >
+    std::pair< iterator, bool > emplace( TArgs&&... args );
+
+    iterator erase( const_iterator pos );
+
+    std::size_t erase( key_type const& key );
+
+protected:
+    // Constructs the element of a missing key through `construct( slot )`. The slot only becomes
+    // occupied afterwards, so a throwing constructor leaves the table without the key.
+    template < typename TConstruct >
+    std::pair< iterator, bool > insertIfMissing( key_type const& key,
+                                                 TConstruct const& construct );
+
+    TSlot* m_slots{ nullptr };
+
+private:
+    static constexpr auto GROUP_SIZE = 16uz;
+    static constexpr auto MIN_CAPACITY = GROUP_SIZE;
+
+    // Metadata of unoccupied slots has the sign bit set. Occupied slots store 7 bits of the hash.
+    static constexpr auto EMPTY = std::int8_t{ -128 };
+    static constexpr auto DELETED = std::int8_t{ -2 };
+
+    // Bit i is set if the metadata byte i of the group matches
+    class Group
+    {
+    public:
+        explicit Group( std::int8_t const* control );
+
+        std::uint32_t match( std::int8_t value ) const;
+
+        std::uint32_t matchEmpty() const;
+
+        std::uint32_t matchUnoccupied() const;
+
+    private:
+#ifdef __SSE2__
+        __m128i m_control;
+#else
+        std::int8_t m_control[ GROUP_SIZE ];
+#endif
+    };
+
+    // Slot of a key, with its mixed hash if the key was not found
+    struct SlotLookup
+    {
+        std::size_t index;
+        std::size_t hash;
+        bool found;
+    };
+
+    static std::size_t mix( std::size_t hash );
+
+    static std::size_t maxLoad( std::size_t capacity );
+
+    std::size_t findIndex( key_type const& key ) const;
+
+    // Slot of the key if present, otherwise an unoccupied slot for it after growing if needed
+    SlotLookup findOrPrepareInsert( key_type const& key );
+
+    // First unoccupied slot on the probe sequence of the hash
+    std::size_t findUnoccupied( std::size_t hash ) const;
+
+    void setControl( std::size_t index, std::int8_t value );
+
+    void rehash( std::size_t capacity );
+
+    void destroy();
+
+    std::size_t m_capacity{ 0 };
+    std::size_t m_size{ 0 };
+
+    // Number of empty slots that can still be filled before the table has to grow
+    std::size_t m_growthLeft{ 0 };
+
+    // One byte per slot followed by a copy of the first group for wrapping probes
+    std::unique_ptr< std::int8_t[] > m_control;
+};
+
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+template < bool CONST >
+class FlatHashTable< TSlot, TKeyOf, THash, TEqual >::Iterator
+{
+public:
+    using Table = std::conditional_t< CONST, FlatHashTable const, FlatHashTable >;
+
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = TSlot;
+
+    // Keys of a set cannot be changed through an iterator
+    using reference = std::conditional_t< CONST || std::is_same_v< TSlot, key_type >,
+                                          TSlot const&,
+                                          TSlot& >;
+    using pointer = std::remove_reference_t< reference >*;
+
+    Iterator() = default;
+
+    Iterator( Table* table, std::size_t index ) : m_table{ table }, m_index{ index }
+    {
+        skipUnoccupied();
+    }
+
+    operator Iterator< true >() const
+    {
+        return Iterator< true >{ m_table, m_index };
+    }
+
+    reference operator*() const
+    {
+        return m_table->m_slots[ m_index ];
+    }
+
+    pointer operator->() const
+    {
+        return &m_table->m_slots[ m_index ];
+    }
+
+    Iterator& operator++()
+    {
+        ++m_index;
+        skipUnoccupied();
+        return *this;
+    }
+
+    Iterator operator++( int )
+    {
+        auto const result = *this;
+        ++( *this );
+        return result;
+    }
+
+    bool operator==( Iterator const& rhs ) const
+    {
+        return m_index == rhs.m_index;
+    }
+
+    std::size_t getIndex() const
+    {
+        return m_index;
+    }
+
+private:
+    // Skips whole groups of unoccupied slots at once. Copies of the first group behind the last
+    // slot may match as well, so the index is clamped to the capacity.
+    void skipUnoccupied()
+    {
+        auto const capacity = m_table->m_capacity;
+
+        while( m_index < capacity )
+        {
+            auto const group = Group{ &m_table->m_control[ m_index ] };
+            auto const occupied = ~group.matchUnoccupied() & 0xFFFF;
+
+            if( occupied != 0 )
+            {
+                m_index = std::min( m_index + std::countr_zero( occupied ), capacity );
+                return;
+            }
+
+            m_index += GROUP_SIZE;
+        }
+
+        m_index = capacity;
+    }
+
+    Table* m_table{ nullptr };
+    std::size_t m_index{ 0 };
+};
+
+
+struct FlatSetKeyOf
+{
+    template < typename TSlot >
+    static TSlot const& get( TSlot const& slot )
+    {
+        return slot;
+    }
+};
+
+struct FlatMapKeyOf
+{
+    template < typename TSlot >
+    static auto const& get( TSlot const& slot )
+    {
+        return slot.first;
+    }
+};
+
+
+template < typename TKey,
+           typename THash = std::hash< TKey >,
+           typename TEqual = std::equal_to< TKey > >
+using FlatHashSet = FlatHashTable< TKey, FlatSetKeyOf, THash, TEqual >;
+
+template < typename TKey,
+           typename TValue,
+           typename THash = std::hash< TKey >,
+           typename TEqual = std::equal_to< TKey > >
+class FlatHashMap
+    : public FlatHashTable< std::pair< TKey const, TValue >, FlatMapKeyOf, THash, TEqual >
+{
+public:
+    using Base = FlatHashTable< std::pair< TKey const, TValue >, FlatMapKeyOf, THash, TEqual >;
+    using mapped_type = TValue;
+
+    template < typename... TArgs >
+    std::pair< typename Base::iterator, bool > try_emplace( TKey const& key, TArgs&&... args );
+
+    TValue& operator[]( TKey const& key );
+
+    TValue& at( TKey const& key );
+
+    TValue const& at( TKey const& key ) const;
+};
+
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline FlatHashTable< TSlot, TKeyOf, THash, TEqual >::FlatHashTable( FlatHashTable const& other )
+{
+    reserve( other.size() );
+    for( auto const& slot : other )
+    {
+        insert( slot );
+    }
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline FlatHashTable< TSlot, TKeyOf, THash, TEqual >::FlatHashTable(
+    FlatHashTable&& other ) noexcept
+    : m_slots{ std::exchange( other.m_slots, nullptr ) }
+    , m_capacity{ std::exchange( other.m_capacity, 0 ) }
+    , m_size{ std::exchange( other.m_size, 0 ) }
+    , m_growthLeft{ std::exchange( other.m_growthLeft, 0 ) }
+    , m_control{ std::move( other.m_control ) }
+{
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::operator=( FlatHashTable other ) noexcept
+    -> FlatHashTable&
+{
+    std::swap( m_slots, other.m_slots );
+    std::swap( m_capacity, other.m_capacity );
+    std::swap( m_size, other.m_size );
+    std::swap( m_growthLeft, other.m_growthLeft );
+    std::swap( m_control, other.m_control );
+    return *this;
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline FlatHashTable< TSlot, TKeyOf, THash, TEqual >::~FlatHashTable()
+{
+    destroy();
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::begin() -> iterator
+{
+    return iterator{ this, 0 };
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::end() -> iterator
+{
+    return iterator{ this, m_capacity };
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::begin() const -> const_iterator
+{
+    return const_iterator{ this, 0 };
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::end() const -> const_iterator
+{
+    return const_iterator{ this, m_capacity };
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline bool FlatHashTable< TSlot, TKeyOf, THash, TEqual >::empty() const
+{
+    return m_size == 0;
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::size_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::size() const
+{
+    return m_size;
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::size_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::capacity() const
+{
+    return m_capacity;
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline void FlatHashTable< TSlot, TKeyOf, THash, TEqual >::reserve( std::size_t count )
+{
+    auto capacity = std::max( m_capacity, MIN_CAPACITY );
+    while( maxLoad( capacity ) < count )
+    {
+        capacity *= 2;
+    }
+
+    if( capacity != m_capacity )
+    {
+        rehash( capacity );
+    }
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline void FlatHashTable< TSlot, TKeyOf, THash, TEqual >::clear()
+{
+    if( m_capacity == 0 )
+    {
+        return;
+    }
+
+    if constexpr( !std::is_trivially_destructible_v< TSlot > )
+    {
+        for( auto i = 0uz; i < m_capacity; ++i )
+        {
+            if( m_control[ i ] >= 0 )
+            {
+                std::destroy_at( &m_slots[ i ] );
+            }
+        }
+    }
+
+    std::memset( m_control.get(), EMPTY, m_capacity + GROUP_SIZE );
+    m_size = 0;
+    m_growthLeft = maxLoad( m_capacity );
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::find( key_type const& key ) -> iterator
+{
+    return iterator{ this, findIndex( key ) };
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::find( key_type const& key ) const
+    -> const_iterator
+{
+    return const_iterator{ this, findIndex( key ) };
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline bool FlatHashTable< TSlot, TKeyOf, THash, TEqual >::contains( key_type const& key ) const
+{
+    return findIndex( key ) != m_capacity;
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::insert( TSlot const& value )
+    -> std::pair< iterator, bool >
+{
+    return insertIfMissing( TKeyOf::get( value ),
+                            [ & ]( TSlot* slot )
+                            {
+                                std::construct_at( slot, value );
+                            } );
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::insert( TSlot&& value )
+    -> std::pair< iterator, bool >
+{
+    return insertIfMissing( TKeyOf::get( value ),
+                            [ & ]( TSlot* slot )
+                            {
+                                std::construct_at( slot, std::move( value ) );
+                            } );
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+template < typename... TArgs >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::emplace( TArgs&&... args )
+    -> std::pair< iterator, bool >
+{
+    return insert( TSlot( std::forward< TArgs >( args )... ) );
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::erase( const_iterator pos ) -> iterator
+{
+    auto const index = pos.getIndex();
+
+    std::destroy_at( &m_slots[ index ] );
+    setControl( index, DELETED );
+    --m_size;
+
+    return iterator{ this, index + 1 };
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::size_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::erase( key_type const& key )
+{
+    auto const index = findIndex( key );
+    if( index == m_capacity )
+    {
+        return 0;
+    }
+
+    erase( const_iterator{ this, index } );
+    return 1;
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+template < typename TConstruct >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::insertIfMissing(
+    key_type const& key,
+    TConstruct const& construct ) -> std::pair< iterator, bool >
+{
+    auto const [ index, hash, found ] = findOrPrepareInsert( key );
+
+    if( !found )
+    {
+        construct( &m_slots[ index ] );
+
+        if( m_control[ index ] == EMPTY )
+        {
+            --m_growthLeft;
+        }
+
+        setControl( index, static_cast< std::int8_t >( hash & 0x7F ) );
+        ++m_size;
+    }
+
+    return { iterator{ this, index }, !found };
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline FlatHashTable< TSlot, TKeyOf, THash, TEqual >::Group::Group( std::int8_t const* control )
+{
+#ifdef __SSE2__
+    m_control = _mm_loadu_si128( reinterpret_cast< __m128i const* >( control ) );
+#else
+    std::memcpy( m_control, control, GROUP_SIZE );
+#endif
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::uint32_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::Group::match(
+    std::int8_t value ) const
+{
+#ifdef __SSE2__
+    return _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_set1_epi8( value ), m_control ) );
+#else
+    auto mask = 0u;
+    for( auto i = 0uz; i < GROUP_SIZE; ++i )
+    {
+        mask |= static_cast< std::uint32_t >( m_control[ i ] == value ) << i;
+    }
+    return mask;
+#endif
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::uint32_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::Group::matchEmpty() const
+{
+    return match( EMPTY );
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::uint32_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::Group::matchUnoccupied() const
+{
+#ifdef __SSE2__
+    return _mm_movemask_epi8( m_control );
+#else
+    auto mask = 0u;
+    for( auto i = 0uz; i < GROUP_SIZE; ++i )
+    {
+        mask |= static_cast< std::uint32_t >( m_control[ i ] < 0 ) << i;
+    }
+    return mask;
+#endif
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::size_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::mix( std::size_t hash )
+{
+    auto const product = static_cast< unsigned __int128 >( hash ) * 0x9E3779B97F4A7C15ull;
+    return static_cast< std::size_t >( product ) ^ static_cast< std::size_t >( product >> 64 );
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::size_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::maxLoad( std::size_t capacity )
+{
+    return capacity - capacity / 8;
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::size_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::findIndex(
+    key_type const& key ) const
+{
+    if( m_size == 0 )
+    {
+        return m_capacity;
+    }
+
+    auto const hash = mix( THash{}( key ) );
+    auto const tag = static_cast< std::int8_t >( hash & 0x7F );
+    auto const mask = m_capacity - 1;
+
+    // Triangular steps over whole groups visit every group of a power of two capacity
+    for( auto pos = ( hash >> 7 ) & mask, step = 0uz;; step += GROUP_SIZE )
+    {
+        auto const group = Group{ &m_control[ pos ] };
+
+        for( auto matches = group.match( tag ); matches != 0; matches &= matches - 1 )
+        {
+            auto const index = ( pos + std::countr_zero( matches ) ) & mask;
+            if( TEqual{}( TKeyOf::get( m_slots[ index ] ), key ) )
+            {
+                return index;
+            }
+        }
+
+        if( group.matchEmpty() != 0 )
+        {
+            return m_capacity;
+        }
+
+        pos = ( pos + step + GROUP_SIZE ) & mask;
+    }
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline auto FlatHashTable< TSlot, TKeyOf, THash, TEqual >::findOrPrepareInsert(
+    key_type const& key ) -> SlotLookup
+{
+    if( auto const index = findIndex( key ); index != m_capacity )
+    {
+        return { index, 0, true };
+    }
+
+    auto const hash = mix( THash{}( key ) );
+    auto index = m_capacity == 0 ? 0 : findUnoccupied( hash );
+
+    // Reusing a deleted slot does not reduce the number of empty ones
+    if( m_capacity == 0 || ( m_growthLeft == 0 && m_control[ index ] == EMPTY ) )
+    {
+        // Tables that are mostly tombstones are cleaned up in place instead of growing
+        auto const grow = m_size * 2 >= maxLoad( m_capacity );
+        rehash( grow ? std::max( m_capacity * 2, MIN_CAPACITY ) : m_capacity );
+        index = findUnoccupied( hash );
+    }
+
+    return { index, hash, false };
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline std::size_t FlatHashTable< TSlot, TKeyOf, THash, TEqual >::findUnoccupied(
+    std::size_t hash ) const
+{
+    auto const mask = m_capacity - 1;
+
+    for( auto pos = ( hash >> 7 ) & mask, step = 0uz;; step += GROUP_SIZE )
+    {
+        if( auto const unoccupied = Group{ &m_control[ pos ] }.matchUnoccupied() )
+        {
+            return ( pos + std::countr_zero( unoccupied ) ) & mask;
+        }
+
+        pos = ( pos + step + GROUP_SIZE ) & mask;
+    }
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline void FlatHashTable< TSlot, TKeyOf, THash, TEqual >::setControl( std::size_t index,
+                                                                      std::int8_t value )
+{
+    m_control[ index ] = value;
+
+    if( index < GROUP_SIZE )
+    {
+        m_control[ m_capacity + index ] = value;
+    }
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline void FlatHashTable< TSlot, TKeyOf, THash, TEqual >::rehash( std::size_t capacity )
+{
+    auto old = std::move( *this );
+
+    m_slots = std::allocator< TSlot >{}.allocate( capacity );
+    m_capacity = capacity;
+    m_growthLeft = maxLoad( capacity );
+    m_control = std::make_unique_for_overwrite< std::int8_t[] >( capacity + GROUP_SIZE );
+    std::memset( m_control.get(), EMPTY, capacity + GROUP_SIZE );
+
+    for( auto i = 0uz; i < old.m_capacity; ++i )
+    {
+        if( old.m_control[ i ] < 0 )
+        {
+            continue;
+        }
+
+        auto& slot = old.m_slots[ i ];
+        auto const hash = mix( THash{}( TKeyOf::get( slot ) ) );
+        auto const index = findUnoccupied( hash );
+
+        std::construct_at( &m_slots[ index ], std::move( slot ) );
+        setControl( index, static_cast< std::int8_t >( hash & 0x7F ) );
+        --m_growthLeft;
+        ++m_size;
+    }
+}
+
+template < typename TSlot, typename TKeyOf, typename THash, typename TEqual >
+inline void FlatHashTable< TSlot, TKeyOf, THash, TEqual >::destroy()
+{
+    if( m_slots == nullptr )
+    {
+        return;
+    }
+
+    clear();
+    std::allocator< TSlot >{}.deallocate( m_slots, m_capacity );
+    m_slots = nullptr;
+}
+
+
+template < typename TKey, typename TValue, typename THash, typename TEqual >
+template < typename... TArgs >
+inline auto FlatHashMap< TKey, TValue, THash, TEqual >::try_emplace( TKey const& key,
+                                                                     TArgs&&... args )
+    -> std::pair< typename Base::iterator, bool >
+{
+    auto const construct = [ & ]( typename Base::value_type* slot )
+    {
+        std::construct_at( slot,
+                           std::piecewise_construct,
+                           std::forward_as_tuple( key ),
+                           std::forward_as_tuple( std::forward< TArgs >( args )... ) );
+    };
+
+    return this->insertIfMissing( key, construct );
+}
+
+template < typename TKey, typename TValue, typename THash, typename TEqual >
+inline TValue& FlatHashMap< TKey, TValue, THash, TEqual >::operator[]( TKey const& key )
+{
+    return try_emplace( key ).first->second;
+}
+
+template < typename TKey, typename TValue, typename THash, typename TEqual >
+inline TValue& FlatHashMap< TKey, TValue, THash, TEqual >::at( TKey const& key )
+{
+    auto const iter = this->find( key );
+    if( iter == this->end() )
+    {
+        throw std::out_of_range( "Key not found" );
+    }
+
+    return iter->second;
+}
+
+template < typename TKey, typename TValue, typename THash, typename TEqual >
+inline TValue const& FlatHashMap< TKey, TValue, THash, TEqual >::at( TKey const& key ) const
+{
+    auto const iter = this->find( key );
+    if( iter == this->end() )
+    {
+        throw std::out_of_range( "Key not found" );
+    }
+
+    return iter->second;
+}
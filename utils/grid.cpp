@@ -3,16 +3,30 @@
 #include <stream_utils.hpp>
 
 
-Grid< char > readGrid( std::istream& stream )
+namespace
 {
-    auto values = std::vector< char >{};
-    auto width = 0uz;
-    auto height = 0uz;
-    for( auto const& line : readLines( stream ) )
+    template < typename TGrid >
+    TGrid readCharGrid( std::istream& stream, typename TGrid::Values values )
     {
-        width = line.length();
-        ++height;
-        values.insert( std::end( values ), std::begin( line ), std::end( line ) );
+        auto width = 0uz;
+        auto height = 0uz;
+        for( auto const& line : readLines( stream ) )
+        {
+            width = line.length();
+            ++height;
+            values.insert( std::end( values ), std::begin( line ), std::end( line ) );
+        }
+        return { width, height, std::move( values ) };
     }
-    return { width, height, std::move( values ) };
+}
+
+
+Grid< char > readGrid( std::istream& stream )
+{
+    return readCharGrid< Grid< char > >( stream, {} );
+}
+
+pmr::Grid< char > readGrid( std::istream& stream, std::pmr::memory_resource* resource )
+{
+    return readCharGrid< pmr::Grid< char > >( stream, pmr::Grid< char >::Values{ resource } );
 }
@@ -1,18 +1,36 @@
 #pragma once
 
+#include <cstdint>
 #include <fstream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-#include <std_generator.hpp>
+#include <hash_utils.hpp>
 
 
-template < typename TType >
+template < typename TType, typename TAllocator = std::allocator< TType > >
 class Grid
 {
 public:
-    Grid( std::size_t width, std::size_t height, TType const& value );
+    using Values = std::vector< TType, TAllocator >;
+
+    template < bool WITH_VALUE >
+    class CellIterator;
+
+    template < bool WITH_VALUE >
+    class CellRange;
 
-    Grid( std::size_t width, std::size_t height, std::vector< TType > values );
+    Grid( std::size_t width,
+          std::size_t height,
+          TType const& value,
+          TAllocator const& allocator = {} );
+
+    Grid( std::size_t width, std::size_t height, Values values );
 
     std::size_t getWidth() const;
 
@@ -24,91 +42,370 @@ public:
 
     TType& operator()( std::size_t x, std::size_t y );
 
-    std::vector< TType > const& getValues() const;
+    Values const& getValues() const;
+
+    // Tuples of x, y and value in row order
+    CellRange< true > getElements() const;
 
-    std::generator< std::tuple< std::size_t, std::size_t, TType const& > > getElements() const;
+    // Tuples of x and y in row order
+    CellRange< false > getPositions() const;
 
-    std::generator< std::tuple< std::size_t, std::size_t > > getPositions() const;
+    bool operator==( Grid const& rhs ) const = default;
 
 private:
     std::size_t m_width;
     std::size_t m_height;
-    std::vector< TType > m_values;
+    Values m_values;
 };
 
+// Walks the cells in row order with a plain pointer instead of a coroutine, so range-for loops
+// over it compile to nested loops
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+class Grid< TType, TAllocator >::CellIterator
+{
+public:
+    using value_type = std::conditional_t< WITH_VALUE,
+                                           std::tuple< std::size_t, std::size_t, TType const& >,
+                                           std::tuple< std::size_t, std::size_t > >;
+    using difference_type = std::ptrdiff_t;
 
-Grid< char > readGrid( std::istream& stream );
+    CellIterator() = default;
 
+    explicit CellIterator( Grid const& grid );
 
-template < typename TType >
-inline Grid< TType >::Grid( std::size_t width, std::size_t height, TType const& value )
-    : m_width{ width }, m_height{ height }, m_values( m_width * m_height, value )
+    value_type operator*() const;
+
+    CellIterator& operator++();
+
+    CellIterator operator++( int );
+
+    bool operator==( std::default_sentinel_t ) const;
+
+private:
+    TType const* m_value{ nullptr };
+    std::size_t m_width{ 0 };
+    std::size_t m_height{ 0 };
+    std::size_t m_x{ 0 };
+    std::size_t m_y{ 0 };
+};
+
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+class Grid< TType, TAllocator >::CellRange
 {
+public:
+    explicit CellRange( Grid const& grid );
+
+    CellIterator< WITH_VALUE > begin() const;
+
+    std::default_sentinel_t end() const;
+
+private:
+    Grid const& m_grid;
+};
+
+namespace pmr
+{
+    // Grid whose cells are allocated from a memory resource, e.g. an Arena
+    template < typename TType >
+    using Grid = ::Grid< TType, std::pmr::polymorphic_allocator< TType > >;
 }
 
+
+// Grid that keeps a Zobrist fingerprint of its contents. Every cell gets a random key and the
+// fingerprint is the XOR of the keys of all cells mixed with their values, so a write only
+// has to swap out the contribution of the one cell it touches.
+template < typename TType >
+class ZobristGrid
+{
+public:
+    class Reference;
+
+    explicit ZobristGrid( Grid< TType > grid );
+
+    std::size_t getWidth() const;
+
+    std::size_t getHeight() const;
+
+    bool isInside( std::size_t x, std::size_t y ) const;
+
+    TType const& operator()( std::size_t x, std::size_t y ) const;
+
+    Reference operator()( std::size_t x, std::size_t y );
+
+    Grid< TType > const& getGrid() const;
+
+    std::uint64_t getHash() const;
+
+    bool operator==( ZobristGrid const& rhs ) const;
+
+private:
+    std::uint64_t computeKey( std::size_t x, std::size_t y, TType const& value ) const;
+
+    Grid< TType > m_grid;
+    std::vector< std::uint64_t > m_cellKeys;
+    std::uint64_t m_hash{ 0 };
+};
+
+// Writes through this reference update the fingerprint of the owning grid
 template < typename TType >
-inline Grid< TType >::Grid( std::size_t width, std::size_t height, std::vector< TType > values )
+class ZobristGrid< TType >::Reference
+{
+public:
+    Reference( ZobristGrid& grid, std::size_t x, std::size_t y );
+
+    Reference& operator=( TType const& value );
+
+    Reference& operator=( Reference const& other );
+
+    operator TType const&() const;
+
+private:
+    ZobristGrid& m_owner;
+    std::size_t m_x;
+    std::size_t m_y;
+};
+
+
+Grid< char > readGrid( std::istream& stream );
+
+pmr::Grid< char > readGrid( std::istream& stream, std::pmr::memory_resource* resource );
+
+
+template < typename TType, typename TAllocator >
+inline Grid< TType, TAllocator >::Grid( std::size_t width,
+                                       std::size_t height,
+                                       TType const& value,
+                                       TAllocator const& allocator )
+    : m_width{ width }, m_height{ height }, m_values( m_width * m_height, value, allocator )
+{
+}
+
+template < typename TType, typename TAllocator >
+inline Grid< TType, TAllocator >::Grid( std::size_t width, std::size_t height, Values values )
     : m_width{ width }, m_height{ height }, m_values( std::move( values ) )
 {
 }
 
-template < typename TType >
-inline std::size_t Grid< TType >::getWidth() const
+template < typename TType, typename TAllocator >
+inline std::size_t Grid< TType, TAllocator >::getWidth() const
 {
     return m_width;
 }
 
-template < typename TType >
-inline std::size_t Grid< TType >::getHeight() const
+template < typename TType, typename TAllocator >
+inline std::size_t Grid< TType, TAllocator >::getHeight() const
 {
     return m_height;
 }
 
-template < typename TType >
-inline bool Grid< TType >::isInside( std::size_t x, std::size_t y ) const
+template < typename TType, typename TAllocator >
+inline bool Grid< TType, TAllocator >::isInside( std::size_t x, std::size_t y ) const
 {
     return x >= 0 && x < m_width && y >= 0 && y < m_height;
 }
 
-template < typename TType >
-inline TType const& Grid< TType >::operator()( std::size_t x, std::size_t y ) const
+template < typename TType, typename TAllocator >
+inline TType const& Grid< TType, TAllocator >::operator()( std::size_t x, std::size_t y ) const
 {
     return m_values[ x + y * m_width ];
 }
 
-template < typename TType >
-inline TType& Grid< TType >::operator()( std::size_t x, std::size_t y )
+template < typename TType, typename TAllocator >
+inline TType& Grid< TType, TAllocator >::operator()( std::size_t x, std::size_t y )
 {
     return m_values[ x + y * m_width ];
 }
 
-template < typename TType >
-inline std::vector< TType > const& Grid< TType >::getValues() const
+template < typename TType, typename TAllocator >
+inline auto Grid< TType, TAllocator >::getValues() const -> Values const&
 {
     return m_values;
 }
 
-template < typename TType >
-std::generator< std::tuple< std::size_t, std::size_t, TType const& > >
-    Grid< TType >::Grid::getElements() const
+template < typename TType, typename TAllocator >
+inline auto Grid< TType, TAllocator >::getElements() const -> CellRange< true >
+{
+    return CellRange< true >{ *this };
+}
+
+template < typename TType, typename TAllocator >
+inline auto Grid< TType, TAllocator >::getPositions() const -> CellRange< false >
+{
+    return CellRange< false >{ *this };
+}
+
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+inline Grid< TType, TAllocator >::CellIterator< WITH_VALUE >::CellIterator( Grid const& grid )
+    : m_value{ grid.m_values.data() }
+    , m_width{ grid.m_width }
+    , m_height{ grid.m_width == 0 ? 0 : grid.m_height }
+{
+}
+
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+inline auto Grid< TType, TAllocator >::CellIterator< WITH_VALUE >::operator*() const -> value_type
+{
+    if constexpr( WITH_VALUE )
+    {
+        return { m_x, m_y, *m_value };
+    }
+    else
+    {
+        return { m_x, m_y };
+    }
+}
+
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+inline auto Grid< TType, TAllocator >::CellIterator< WITH_VALUE >::operator++() -> CellIterator&
 {
-    for( std::size_t y = 0; y < m_height; ++y )
+    ++m_value;
+    if( ++m_x == m_width )
     {
-        for( std::size_t x = 0; x < m_width; ++x )
-        {
-            co_yield std::make_tuple( x, y, ( *this )( x, y ) );
-        }
+        m_x = 0;
+        ++m_y;
     }
+    return *this;
+}
+
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+inline auto Grid< TType, TAllocator >::CellIterator< WITH_VALUE >::operator++( int ) -> CellIterator
+{
+    auto const previous = *this;
+    ++*this;
+    return previous;
+}
+
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+inline bool Grid< TType, TAllocator >::CellIterator< WITH_VALUE >::operator==(
+    std::default_sentinel_t ) const
+{
+    return m_y == m_height;
+}
+
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+inline Grid< TType, TAllocator >::CellRange< WITH_VALUE >::CellRange( Grid const& grid )
+    : m_grid{ grid }
+{
+}
+
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+inline auto Grid< TType, TAllocator >::CellRange< WITH_VALUE >::begin() const
+    -> CellIterator< WITH_VALUE >
+{
+    return CellIterator< WITH_VALUE >{ m_grid };
+}
+
+template < typename TType, typename TAllocator >
+template < bool WITH_VALUE >
+inline std::default_sentinel_t Grid< TType, TAllocator >::CellRange< WITH_VALUE >::end() const
+{
+    return std::default_sentinel;
 }
 
 template < typename TType >
-std::generator< std::tuple< std::size_t, std::size_t > > Grid< TType >::Grid::getPositions() const
+inline ZobristGrid< TType >::ZobristGrid( Grid< TType > grid )
+    : m_grid{ std::move( grid ) }, m_cellKeys( m_grid.getWidth() * m_grid.getHeight() )
 {
-    for( std::size_t y = 0; y < m_height; ++y )
+    for( std::size_t i = 0; i < m_cellKeys.size(); ++i )
+    {
+        m_cellKeys[ i ] = mixHash( i ^ HASH_SECRETS[ 0 ], HASH_SECRETS[ 1 ] );
+    }
+
+    for( auto const& [ x, y, value ] : m_grid.getElements() )
     {
-        for( std::size_t x = 0; x < m_width; ++x )
-        {
-            co_yield std::make_tuple( x, y );
-        }
+        m_hash ^= computeKey( x, y, value );
     }
 }
+
+template < typename TType >
+inline std::size_t ZobristGrid< TType >::getWidth() const
+{
+    return m_grid.getWidth();
+}
+
+template < typename TType >
+inline std::size_t ZobristGrid< TType >::getHeight() const
+{
+    return m_grid.getHeight();
+}
+
+template < typename TType >
+inline bool ZobristGrid< TType >::isInside( std::size_t x, std::size_t y ) const
+{
+    return m_grid.isInside( x, y );
+}
+
+template < typename TType >
+inline TType const& ZobristGrid< TType >::operator()( std::size_t x, std::size_t y ) const
+{
+    return m_grid( x, y );
+}
+
+template < typename TType >
+inline auto ZobristGrid< TType >::operator()( std::size_t x, std::size_t y ) -> Reference
+{
+    return { *this, x, y };
+}
+
+template < typename TType >
+inline Grid< TType > const& ZobristGrid< TType >::getGrid() const
+{
+    return m_grid;
+}
+
+template < typename TType >
+inline std::uint64_t ZobristGrid< TType >::getHash() const
+{
+    return m_hash;
+}
+
+template < typename TType >
+inline bool ZobristGrid< TType >::operator==( ZobristGrid const& rhs ) const
+{
+    return m_hash == rhs.m_hash && m_grid == rhs.m_grid;
+}
+
+template < typename TType >
+inline std::uint64_t
+    ZobristGrid< TType >::computeKey( std::size_t x, std::size_t y, TType const& value ) const
+{
+    auto const valueHash = static_cast< std::uint64_t >( std::hash< TType >{}( value ) );
+    return mixHash( m_cellKeys[ x + y * m_grid.getWidth() ], valueHash ^ HASH_SECRETS[ 2 ] );
+}
+
+template < typename TType >
+inline ZobristGrid< TType >::Reference::Reference( ZobristGrid& grid, std::size_t x, std::size_t y )
+    : m_owner{ grid }, m_x{ x }, m_y{ y }
+{
+}
+
+template < typename TType >
+inline auto ZobristGrid< TType >::Reference::operator=( TType const& value ) -> Reference&
+{
+    auto& cell = m_owner.m_grid( m_x, m_y );
+    m_owner.m_hash ^=
+        m_owner.computeKey( m_x, m_y, cell ) ^ m_owner.computeKey( m_x, m_y, value );
+    cell = value;
+    return *this;
+}
+
+template < typename TType >
+inline auto ZobristGrid< TType >::Reference::operator=( Reference const& other ) -> Reference&
+{
+    return *this = static_cast< TType const& >( other );
+}
+
+template < typename TType >
+inline ZobristGrid< TType >::Reference::operator TType const&() const
+{
+    return std::as_const( m_owner )( m_x, m_y );
+}
@@ -0,0 +1,99 @@
+#include <hash_utils.hpp>
+
+#include <cstring>
+
+
+namespace
+{
+    std::uint64_t read8( std::byte const* data )
+    {
+        auto value = std::uint64_t{};
+        std::memcpy( &value, data, sizeof( value ) );
+        return value;
+    }
+
+    std::uint64_t read4( std::byte const* data )
+    {
+        auto value = std::uint32_t{};
+        std::memcpy( &value, data, sizeof( value ) );
+        return value;
+    }
+
+    // One to three bytes spread over the first, middle and last byte
+    std::uint64_t read3( std::byte const* data, std::size_t size )
+    {
+        return ( std::to_integer< std::uint64_t >( data[ 0 ] ) << 16 ) |
+               ( std::to_integer< std::uint64_t >( data[ size / 2 ] ) << 8 ) |
+               std::to_integer< std::uint64_t >( data[ size - 1 ] );
+    }
+}
+
+
+std::uint64_t hashBytes( std::span< std::byte const > bytes, std::uint64_t seed )
+{
+    auto const& s = HASH_SECRETS;
+    auto const* data = bytes.data();
+    auto const size = bytes.size();
+
+    seed ^= mixHash( seed ^ s[ 0 ], s[ 1 ] );
+
+    auto a = std::uint64_t{ 0 };
+    auto b = std::uint64_t{ 0 };
+
+    if( size <= 16 )
+    {
+        if( size >= 4 )
+        {
+            auto const offset = ( size >> 3 ) << 2;
+            a = ( read4( data ) << 32 ) | read4( data + offset );
+            b = ( read4( data + size - 4 ) << 32 ) | read4( data + size - 4 - offset );
+        }
+        else if( size > 0 )
+        {
+            a = read3( data, size );
+        }
+    }
+    else
+    {
+        auto remaining = size;
+
+        // Three independent lanes hide the latency of the multiplications
+        if( remaining > 48 )
+        {
+            auto seed1 = seed;
+            auto seed2 = seed;
+
+            do
+            {
+                seed = mixHash( read8( data ) ^ s[ 1 ], read8( data + 8 ) ^ seed );
+                seed1 = mixHash( read8( data + 16 ) ^ s[ 2 ], read8( data + 24 ) ^ seed1 );
+                seed2 = mixHash( read8( data + 32 ) ^ s[ 3 ], read8( data + 40 ) ^ seed2 );
+                data += 48;
+                remaining -= 48;
+            } while( remaining > 48 );
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while( remaining > 16 )
+        {
+            seed = mixHash( read8( data ) ^ s[ 1 ], read8( data + 8 ) ^ seed );
+            data += 16;
+            remaining -= 16;
+        }
+
+        a = read8( data + remaining - 16 );
+        b = read8( data + remaining - 8 );
+    }
+
+    auto const product = static_cast< unsigned __int128 >( a ^ s[ 1 ] ) * ( b ^ seed );
+    a = static_cast< std::uint64_t >( product );
+    b = static_cast< std::uint64_t >( product >> 64 );
+
+    return mixHash( a ^ s[ 0 ] ^ size, b ^ s[ 1 ] );
+}
+
+Hash128 hashBytes128( std::span< std::byte const > bytes )
+{
+    return Hash128{ hashBytes( bytes, HASH_SECRETS[ 2 ] ), hashBytes( bytes, HASH_SECRETS[ 3 ] ) };
+}
@@ -1,8 +1,23 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <functional>
+#include <span>
+#include <vector>
 
 
+// Odd constants with balanced bits used to seed and mix the hashes
+inline constexpr auto HASH_SECRETS = std::array< std::uint64_t, 4 >{
+    0x2d358dccaa6c78a5ull,
+    0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull,
+    0x4d5a2da51de1aa47ull,
+};
+
+// Multiplies both values to 128 bits and folds the halves (the wyhash "mum" mixer)
+std::uint64_t mixHash( std::uint64_t lhs, std::uint64_t rhs );
+
 class HashComputer
 {
 public:
@@ -12,7 +27,7 @@ public:
     std::size_t getValue() const;
 
 private:
-    std::size_t m_value{ 0 };
+    std::uint64_t m_value{ 0 };
 };
 
 template < typename TType >
@@ -32,16 +47,38 @@ struct std::hash< std::vector< TType > >
 template < typename TType >
 std::size_t computeHash( TType const& value );
 
+// 64 bit hash of raw bytes in the style of wyhash
+std::uint64_t hashBytes( std::span< std::byte const > bytes, std::uint64_t seed = 0 );
+
+struct Hash128
+{
+    std::uint64_t low;
+    std::uint64_t high;
+
+    bool operator==( Hash128 const& rhs ) const = default;
+};
+
+// Two independently seeded 64 bit hashes, for fingerprints that have to be collision free in
+// practice
+Hash128 hashBytes128( std::span< std::byte const > bytes );
+
+
+inline std::uint64_t mixHash( std::uint64_t lhs, std::uint64_t rhs )
+{
+    auto const product = static_cast< unsigned __int128 >( lhs ) * rhs;
+    return static_cast< std::uint64_t >( product ) ^ static_cast< std::uint64_t >( product >> 64 );
+}
 
 template < typename TType >
 inline void HashComputer::push( TType value )
 {
-    m_value ^= std::hash< TType >{}( value ) + ( m_value << 6 ) + ( m_value >> 2 );
+    auto const hash = static_cast< std::uint64_t >( std::hash< TType >{}( value ) );
+    m_value = mixHash( m_value ^ HASH_SECRETS[ 0 ], hash ^ HASH_SECRETS[ 1 ] );
 }
 
 inline std::size_t HashComputer::getValue() const
 {
-    return m_value;
+    return mixHash( m_value ^ HASH_SECRETS[ 2 ], HASH_SECRETS[ 3 ] );
 }
 
 template < typename TType >
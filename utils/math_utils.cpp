@@ -1,11 +1,19 @@
 #include <math_utils.hpp>
 
 #include <cmath>
+#include <stdexcept>
+#include <utility>
 
 
 long lcm( long lhs, long rhs )
 {
-    return lhs * rhs / gcd( lhs, rhs );
+    auto result = 0L;
+    if( __builtin_mul_overflow( lhs / gcd( lhs, rhs ), rhs, &result ) )
+    {
+        throw std::overflow_error( "Least common multiple exceeds long" );
+    }
+
+    return result;
 }
 
 long gcd( long lhs, long rhs )
@@ -44,3 +52,39 @@ std::unordered_map< long, long > computePrimeFactors( long n )
 
     return factors;
 }
+
+Congruence combineCongruences( Congruence const& lhs, Congruence const& rhs )
+{
+    auto const divisor = gcd( lhs.modulus, rhs.modulus );
+    auto const diff = rhs.remainder - lhs.remainder;
+
+    if( diff % divisor != 0 )
+    {
+        throw std::runtime_error( "Congruences have no common solution" );
+    }
+
+    // Solve lhs.modulus * k = diff (mod rhs.modulus) with the extended Euclidean algorithm
+    auto const reducedModulus = rhs.modulus / divisor;
+    auto oldR = static_cast< __int128 >( lhs.modulus / divisor ) % reducedModulus;
+    auto r = static_cast< __int128 >( reducedModulus );
+    auto oldS = static_cast< __int128 >( 1 );
+    auto s = static_cast< __int128 >( 0 );
+
+    while( r != 0 )
+    {
+        auto const quotient = oldR / r;
+        oldR = std::exchange( r, oldR - quotient * r );
+        oldS = std::exchange( s, oldS - quotient * s );
+    }
+
+    auto const modulus = lcm( lhs.modulus, rhs.modulus );
+    auto const k = ( oldS * ( diff / divisor ) ) % reducedModulus;
+    auto remainder = ( lhs.remainder + lhs.modulus * k ) % modulus;
+
+    if( remainder < 0 )
+    {
+        remainder += modulus;
+    }
+
+    return { static_cast< long >( remainder ), modulus };
+}
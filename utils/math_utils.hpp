@@ -3,7 +3,7 @@
 #include <unordered_map>
 
 
-// Least common multiple
+// Least common multiple. Throws std::overflow_error if the result does not fit into a long.
 long lcm( long lhs, long rhs );
 
 // Greatest common divisor
@@ -11,3 +11,16 @@ long gcd( long lhs, long rhs );
 
 
 std::unordered_map< long, long > computePrimeFactors( long n );
+
+
+// Set of integers x with x = remainder (mod modulus)
+struct Congruence
+{
+    long remainder;
+    long modulus;
+};
+
+// Chinese remainder theorem for arbitrary (not necessarily coprime) moduli. Throws
+// std::runtime_error if the congruences have no common solution and std::overflow_error if the
+// combined modulus does not fit into a long.
+Congruence combineCongruences( Congruence const& lhs, Congruence const& rhs );
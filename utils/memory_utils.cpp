@@ -0,0 +1,115 @@
+#include <memory_utils.hpp>
+
+#include <algorithm>
+#include <array>
+#include <new>
+#include <utility>
+
+
+namespace
+{
+    // Frames are pooled in size classes of this granularity up to the maximum size
+    constexpr auto FRAME_GRANULARITY = std::size_t{ 64 };
+    constexpr auto MAX_POOLED_FRAME_SIZE = std::size_t{ 1024 };
+
+    struct FreeFrame
+    {
+        FreeFrame* next;
+    };
+
+    class FramePool
+    {
+    public:
+        FramePool() = default;
+
+        FramePool( FramePool const& ) = delete;
+
+        FramePool& operator=( FramePool const& ) = delete;
+
+        ~FramePool();
+
+        void* allocate( std::size_t size );
+
+        void deallocate( void* frame, std::size_t size ) noexcept;
+
+    private:
+        static std::size_t getSizeClass( std::size_t size );
+
+        std::array< FreeFrame*, MAX_POOLED_FRAME_SIZE / FRAME_GRANULARITY > m_freeLists{};
+    };
+
+    thread_local auto framePool = FramePool{};
+}
+
+
+Arena::Arena()
+    : m_arena{ INITIAL_SIZE }
+    , m_pool{ std::pmr::pool_options{ 0, MAX_POOLED_SIZE }, &m_arena }
+{
+}
+
+std::pmr::memory_resource* Arena::getResource()
+{
+    return &m_pool;
+}
+
+
+void* allocateFrame( std::size_t size )
+{
+    return framePool.allocate( size );
+}
+
+void deallocateFrame( void* frame, std::size_t size ) noexcept
+{
+    framePool.deallocate( frame, size );
+}
+
+
+namespace
+{
+    FramePool::~FramePool()
+    {
+        for( auto* frame : m_freeLists )
+        {
+            while( frame )
+            {
+                ::operator delete( std::exchange( frame, frame->next ) );
+            }
+        }
+    }
+
+    void* FramePool::allocate( std::size_t size )
+    {
+        if( size > MAX_POOLED_FRAME_SIZE )
+        {
+            return ::operator new( size );
+        }
+
+        auto const sizeClass = getSizeClass( size );
+        auto*& freeList = m_freeLists[ sizeClass ];
+
+        if( !freeList )
+        {
+            return ::operator new( ( sizeClass + 1 ) * FRAME_GRANULARITY );
+        }
+
+        return std::exchange( freeList, freeList->next );
+    }
+
+    void FramePool::deallocate( void* frame, std::size_t size ) noexcept
+    {
+        if( size > MAX_POOLED_FRAME_SIZE )
+        {
+            ::operator delete( frame );
+            return;
+        }
+
+        auto*& freeList = m_freeLists[ getSizeClass( size ) ];
+        freeList = ::new( frame ) FreeFrame{ freeList };
+    }
+
+    std::size_t FramePool::getSizeClass( std::size_t size )
+    {
+        return ( std::max( size, std::size_t{ 1 } ) - 1 ) / FRAME_GRANULARITY;
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+
+// Memory resource for `std::pmr` containers that is released at once when the arena is destroyed.
+// Freed blocks are pooled by size and reused. Containers have to be given getResource()
+// explicitly, the process-wide default resource is left alone. An arena is not thread safe, so
+// each thread needs its own, and it must not back objects that outlive it.
+class Arena
+{
+public:
+    Arena();
+
+    Arena( Arena const& ) = delete;
+
+    Arena& operator=( Arena const& ) = delete;
+
+    std::pmr::memory_resource* getResource();
+
+private:
+    static constexpr auto INITIAL_SIZE = std::size_t{ 1 } << 20;
+
+    // Largest block that is still pooled, bigger ones go straight to the arena
+    static constexpr auto MAX_POOLED_SIZE = std::size_t{ 1 } << 20;
+
+    std::pmr::monotonic_buffer_resource m_arena;
+    std::pmr::unsynchronized_pool_resource m_pool;
+};
+
+
+// Allocator for coroutine frames. Freed frames are kept in per-thread free lists by size, so a
+// generator that is started over and over reuses the same few blocks instead of the heap.
+template < typename TType >
+class FrameAllocator
+{
+public:
+    using value_type = TType;
+
+    FrameAllocator() = default;
+
+    template < typename TOther >
+    FrameAllocator( FrameAllocator< TOther > const& other );
+
+    TType* allocate( std::size_t count );
+
+    void deallocate( TType* pointer, std::size_t count ) noexcept;
+
+    bool operator==( FrameAllocator const& rhs ) const = default;
+};
+
+void* allocateFrame( std::size_t size );
+
+void deallocateFrame( void* frame, std::size_t size ) noexcept;
+
+
+template < typename TType >
+template < typename TOther >
+inline FrameAllocator< TType >::FrameAllocator( FrameAllocator< TOther > const& )
+{
+}
+
+template < typename TType >
+inline TType* FrameAllocator< TType >::allocate( std::size_t count )
+{
+    return static_cast< TType* >( allocateFrame( count * sizeof( TType ) ) );
+}
+
+template < typename TType >
+inline void FrameAllocator< TType >::deallocate( TType* pointer, std::size_t count ) noexcept
+{
+    deallocateFrame( pointer, count * sizeof( TType ) );
+}
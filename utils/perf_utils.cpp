@@ -0,0 +1,326 @@
+#include <perf_utils.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include <sys/resource.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace
+{
+    // perf_event_open group of all counters of the calling thread, opened on first use
+    class PerfCounters
+    {
+    public:
+        PerfCounters();
+
+        ~PerfCounters();
+
+        PerfCounters( PerfCounters const& ) = delete;
+
+        PerfCounters& operator=( PerfCounters const& ) = delete;
+
+        bool isOpen() const;
+
+        // Current counter values, scaled up if the kernel had to multiplex the group
+        std::array< std::uint64_t, PERF_COUNTER_COUNT > read() const;
+
+    private:
+        std::array< int, PERF_COUNTER_COUNT > m_fds;
+    };
+
+    class PerfRegistry
+    {
+    public:
+        void add( std::string const& name, PerfSample const& sample );
+
+        std::vector< std::pair< std::string, PerfSample > > takeSamples();
+
+    private:
+        std::mutex m_mutex;
+        std::vector< std::pair< std::string, PerfSample > > m_samples;
+    };
+
+    PerfSample takeSnapshot();
+
+    PerfSample computeDifference( PerfSample const& end, PerfSample const& start );
+
+    std::chrono::nanoseconds toDuration( timeval const& time );
+
+    double toMilliseconds( std::chrono::nanoseconds duration );
+
+    PerfRegistry& getRegistry();
+}
+
+
+PerfScope::PerfScope( std::string_view name )
+    : m_name{ name }
+    , m_enabled{ isPerfEnabled() }
+    , m_start{ m_enabled ? takeSnapshot() : PerfSample{} }
+{
+}
+
+PerfScope::~PerfScope()
+{
+    if( m_enabled )
+    {
+        getRegistry().add( m_name, computeDifference( takeSnapshot(), m_start ) );
+    }
+}
+
+bool isPerfEnabled()
+{
+    static auto const enabled = std::getenv( "AOC_PERF" ) != nullptr;
+    return enabled;
+}
+
+void printPerfReport()
+{
+    for( auto const& [ name, sample ] : getRegistry().takeSamples() )
+    {
+        fmt::print( stderr,
+                    "{:<20} calls {:>6}  wall {:>10.3f} ms  user {:>10.3f} ms  sys {:>8.3f} ms  "
+                    "page faults {:>8}",
+                    name,
+                    sample.calls,
+                    toMilliseconds( sample.wallTime ),
+                    toMilliseconds( sample.userTime ),
+                    toMilliseconds( sample.systemTime ),
+                    sample.pageFaults );
+
+        if( sample.hasCounters )
+        {
+            auto const& counters = sample.counters;
+            auto const cycles = counters[ std::to_underlying( PerfCounter::CYCLES ) ];
+            auto const instructions = counters[ std::to_underlying( PerfCounter::INSTRUCTIONS ) ];
+
+            fmt::print( stderr,
+                        "  cycles {:>14}  instructions {:>14}  IPC {:>5.2f}  cache misses {:>12}  "
+                        "branch misses {:>12}",
+                        cycles,
+                        instructions,
+                        cycles == 0 ? 0.0 : static_cast< double >( instructions ) / cycles,
+                        counters[ std::to_underlying( PerfCounter::CACHE_MISSES ) ],
+                        counters[ std::to_underlying( PerfCounter::BRANCH_MISSES ) ] );
+        }
+
+        fmt::print( stderr, "\n" );
+    }
+}
+
+
+namespace
+{
+    thread_local auto const perfCounters = PerfCounters{};
+
+#ifdef __linux__
+    PerfCounters::PerfCounters()
+    {
+        static constexpr auto EVENTS = std::array< std::uint64_t, PERF_COUNTER_COUNT >{
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+
+        m_fds.fill( -1 );
+
+        for( auto i = 0uz; i < EVENTS.size(); ++i )
+        {
+            auto attributes = perf_event_attr{};
+            attributes.type = PERF_TYPE_HARDWARE;
+            attributes.size = sizeof( attributes );
+            attributes.config = EVENTS[ i ];
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            auto const fd = static_cast< int >(
+                syscall( SYS_perf_event_open, &attributes, 0, -1, m_fds[ 0 ], 0 ) );
+
+            // Without the complete group the numbers are not comparable between runs
+            if( fd < 0 )
+            {
+                for( auto& openFd : m_fds )
+                {
+                    if( openFd >= 0 )
+                    {
+                        close( std::exchange( openFd, -1 ) );
+                    }
+                }
+                return;
+            }
+
+            m_fds[ i ] = fd;
+        }
+    }
+
+    PerfCounters::~PerfCounters()
+    {
+        for( auto const fd : m_fds )
+        {
+            if( fd >= 0 )
+            {
+                close( fd );
+            }
+        }
+    }
+
+    bool PerfCounters::isOpen() const
+    {
+        return m_fds[ 0 ] >= 0;
+    }
+
+    std::array< std::uint64_t, PERF_COUNTER_COUNT > PerfCounters::read() const
+    {
+        struct GroupValues
+        {
+            std::uint64_t count;
+            std::uint64_t timeEnabled;
+            std::uint64_t timeRunning;
+            std::array< std::uint64_t, PERF_COUNTER_COUNT > values;
+        };
+
+        auto group = GroupValues{};
+        auto counters = std::array< std::uint64_t, PERF_COUNTER_COUNT >{};
+
+        if( ::read( m_fds[ 0 ], &group, sizeof( group ) ) != sizeof( group ) ||
+            group.timeRunning == 0 )
+        {
+            return counters;
+        }
+
+        auto const scale = static_cast< double >( group.timeEnabled ) / group.timeRunning;
+        for( auto i = 0uz; i < counters.size(); ++i )
+        {
+            counters[ i ] = static_cast< std::uint64_t >( group.values[ i ] * scale );
+        }
+
+        return counters;
+    }
+#else
+    PerfCounters::PerfCounters()
+    {
+        m_fds.fill( -1 );
+    }
+
+    PerfCounters::~PerfCounters() = default;
+
+    bool PerfCounters::isOpen() const
+    {
+        return false;
+    }
+
+    std::array< std::uint64_t, PERF_COUNTER_COUNT > PerfCounters::read() const
+    {
+        return {};
+    }
+#endif
+
+    void PerfRegistry::add( std::string const& name, PerfSample const& sample )
+    {
+        auto const lock = std::lock_guard{ m_mutex };
+
+        auto entry = std::find_if( std::begin( m_samples ),
+                                   std::end( m_samples ),
+                                   [ & ]( auto const& namedSample )
+                                   {
+                                       return namedSample.first == name;
+                                   } );
+
+        if( entry == std::end( m_samples ) )
+        {
+            m_samples.emplace_back( name, PerfSample{ .hasCounters = sample.hasCounters } );
+            entry = std::prev( std::end( m_samples ) );
+        }
+
+        auto& total = entry->second;
+        total.calls += sample.calls;
+        total.wallTime += sample.wallTime;
+        total.userTime += sample.userTime;
+        total.systemTime += sample.systemTime;
+        total.pageFaults += sample.pageFaults;
+        total.hasCounters = total.hasCounters && sample.hasCounters;
+        for( auto i = 0uz; i < total.counters.size(); ++i )
+        {
+            total.counters[ i ] += sample.counters[ i ];
+        }
+    }
+
+    std::vector< std::pair< std::string, PerfSample > > PerfRegistry::takeSamples()
+    {
+        auto const lock = std::lock_guard{ m_mutex };
+        return std::exchange( m_samples, {} );
+    }
+
+    // Absolute values at the current point in time
+    PerfSample takeSnapshot()
+    {
+        auto usage = rusage{};
+        getrusage( RUSAGE_SELF, &usage );
+
+        auto snapshot = PerfSample{
+            .calls = 0,
+            .wallTime = std::chrono::steady_clock::now().time_since_epoch(),
+            .userTime = toDuration( usage.ru_utime ),
+            .systemTime = toDuration( usage.ru_stime ),
+            .pageFaults = usage.ru_minflt + usage.ru_majflt,
+            .hasCounters = perfCounters.isOpen(),
+        };
+
+        if( snapshot.hasCounters )
+        {
+            snapshot.counters = perfCounters.read();
+        }
+
+        return snapshot;
+    }
+
+    PerfSample computeDifference( PerfSample const& end, PerfSample const& start )
+    {
+        auto difference = PerfSample{
+            .calls = 1,
+            .wallTime = end.wallTime - start.wallTime,
+            .userTime = end.userTime - start.userTime,
+            .systemTime = end.systemTime - start.systemTime,
+            .pageFaults = end.pageFaults - start.pageFaults,
+            .hasCounters = end.hasCounters && start.hasCounters,
+        };
+
+        for( auto i = 0uz; i < difference.counters.size(); ++i )
+        {
+            difference.counters[ i ] = end.counters[ i ] - start.counters[ i ];
+        }
+
+        return difference;
+    }
+
+    std::chrono::nanoseconds toDuration( timeval const& time )
+    {
+        return std::chrono::seconds{ time.tv_sec } + std::chrono::microseconds{ time.tv_usec };
+    }
+
+    double toMilliseconds( std::chrono::nanoseconds duration )
+    {
+        return std::chrono::duration< double, std::milli >{ duration }.count();
+    }
+
+    PerfRegistry& getRegistry()
+    {
+        static auto registry = PerfRegistry{};
+        return registry;
+    }
+}
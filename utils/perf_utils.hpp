@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+// Hardware events counted per scope where the kernel exposes them through perf_event_open
+enum class PerfCounter
+{
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+};
+
+inline constexpr auto PERF_COUNTER_COUNT = 4uz;
+
+// Measurements of one phase, summed over all scopes with the same name
+struct PerfSample
+{
+    long calls{ 0 };
+    std::chrono::nanoseconds wallTime{ 0 };
+    std::chrono::nanoseconds userTime{ 0 };
+    std::chrono::nanoseconds systemTime{ 0 };
+    long pageFaults{ 0 };
+    bool hasCounters{ false };
+    std::array< std::uint64_t, PERF_COUNTER_COUNT > counters{};
+};
+
+// Measures the enclosing block as the phase `name`, e.g. `auto scope = PerfScope{ "parse" };`.
+// Scopes may nest and a phase is reported once with the sum of all of its scopes. Does nothing
+// unless the environment variable AOC_PERF is set. Hardware counters only cover the calling
+// thread and are left out if perf_event_open is not available. Wall clock, CPU time and page
+// faults are always reported, the latter two for the whole process.
+class PerfScope
+{
+public:
+    explicit PerfScope( std::string_view name );
+
+    ~PerfScope();
+
+    PerfScope( PerfScope const& ) = delete;
+
+    PerfScope& operator=( PerfScope const& ) = delete;
+
+private:
+    std::string m_name;
+    bool m_enabled;
+    PerfSample m_start;
+};
+
+bool isPerfEnabled();
+
+// Prints all phases measured so far to stderr and clears them
+void printPerfReport();
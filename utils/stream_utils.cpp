@@ -1,5 +1,26 @@
 #include <stream_utils.hpp>
 
+#include <iterator>
+
+#include <memory_utils.hpp>
+
+
+namespace
+{
+    std::generator< std::string const& > readLines( std::allocator_arg_t,
+                                                    FrameAllocator< std::byte >,
+                                                    std::istream& stream )
+    {
+        auto line = std::string{};
+
+        while( std::getline( stream, line ) )
+        {
+            co_yield line;
+        }
+    }
+}
+
+
 void iterateLines( std::istream& stream, LineCallback const& callback )
 {
     auto line = std::string{};
@@ -11,10 +32,10 @@ void iterateLines( std::istream& stream, LineCallback const& callback )
 
 std::generator< std::string const& > readLines( std::istream& stream )
 {
-    auto line = std::string{};
+    return readLines( std::allocator_arg, FrameAllocator< std::byte >{}, stream );
+}
 
-    while( std::getline( stream, line ) )
-    {
-        co_yield line;
-    }
+std::string readAll( std::istream& stream )
+{
+    return { std::istreambuf_iterator< char >{ stream }, std::istreambuf_iterator< char >{} };
 }
@@ -11,3 +11,6 @@ using LineCallback = std::function< void( std::string const& ) >;
 void iterateLines( std::istream& stream, LineCallback const& callback );
 
 std::generator< std::string const& > readLines( std::istream& stream );
+
+// Reads the remaining content of the stream
+std::string readAll( std::istream& stream );
@@ -1,8 +1,47 @@
 #include <string_utils.hpp>
 
+#include <algorithm>
 #include <regex>
 #include <sstream>
 
+#include <memory_utils.hpp>
+
+
+namespace
+{
+    std::generator< std::smatch const& > iterateMatches( std::allocator_arg_t,
+                                                         FrameAllocator< std::byte >,
+                                                         std::string const& line,
+                                                         std::regex const& pattern )
+    {
+        auto begin = std::sregex_iterator{ std::begin( line ), std::end( line ), pattern };
+        auto end = std::sregex_iterator{};
+
+        for( auto match = begin; match != end; ++match )
+        {
+            co_yield *match;
+        }
+    }
+
+    std::generator< std::string_view > splitLines( std::allocator_arg_t,
+                                                   FrameAllocator< std::byte >,
+                                                   std::string_view text )
+    {
+        while( !text.empty() )
+        {
+            auto const end = text.find( '\n' );
+            if( end == std::string_view::npos )
+            {
+                co_yield text;
+                break;
+            }
+
+            co_yield text.substr( 0, end );
+            text.remove_prefix( end + 1 );
+        }
+    }
+}
+
 
 std::vector< std::string > split( std::string const& s, char delim )
 {
@@ -18,17 +57,27 @@ std::vector< std::string > split( std::string const& s, char delim )
     return result;
 }
 
-
-std::generator< std::smatch const& > iterateMatches( std::string const& line,
-                                                     std::regex const& pattern )
+std::pmr::vector< std::pmr::string > split( std::string_view s,
+                                            char delim,
+                                            std::pmr::memory_resource* resource )
 {
-    auto begin = std::sregex_iterator{ std::begin( line ), std::end( line ), pattern };
-    auto end = std::sregex_iterator{};
+    auto result = std::pmr::vector< std::pmr::string >{ resource };
 
-    for( auto match = begin; match != end; ++match )
+    while( !s.empty() )
     {
-        co_yield *match;
+        auto const end = std::min( s.find( delim ), s.size() );
+        result.emplace_back( s.substr( 0, end ) );
+        s.remove_prefix( std::min( end + 1, s.size() ) );
     }
+
+    return result;
+}
+
+
+std::generator< std::smatch const& > iterateMatches( std::string const& line,
+                                                     std::regex const& pattern )
+{
+    return iterateMatches( std::allocator_arg, FrameAllocator< std::byte >{}, line, pattern );
 }
 
 void iterateNumbers( std::string const& line, NumberCallback const& callback, bool withNegatives )
@@ -43,3 +92,30 @@ void iterateNumbers( std::string const& line, NumberCallback const& callback, bo
         callback( std::stol( match->str() ), match->position(), match->length() );
     }
 }
+
+std::generator< std::string_view > splitLines( std::string_view text )
+{
+    return splitLines( std::allocator_arg, FrameAllocator< std::byte >{}, text );
+}
+
+std::vector< std::string_view > splitChunks( std::string_view text, std::size_t count, char delim )
+{
+    auto chunks = std::vector< std::string_view >{};
+    auto const chunkSize = text.size() / std::max( count, 1uz ) + 1;
+
+    while( !text.empty() )
+    {
+        auto end = text.find( delim, std::min( chunkSize, text.size() ) - 1 );
+        end = end == std::string_view::npos ? text.size() : end + 1;
+
+        chunks.push_back( text.substr( 0, end ) );
+        text.remove_prefix( end );
+    }
+
+    return chunks;
+}
+
+std::vector< std::string_view > splitLineChunks( std::string_view text, std::size_t count )
+{
+    return splitChunks( text, count, '\n' );
+}
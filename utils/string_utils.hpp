@@ -1,8 +1,10 @@
 #pragma once
 
 #include <functional>
+#include <memory_resource>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <std_generator.hpp>
@@ -10,6 +12,11 @@
 
 std::vector< std::string > split( std::string const& s, char delim );
 
+// Same as above, with the parts and the result allocated from `resource`
+std::pmr::vector< std::pmr::string > split( std::string_view s,
+                                            char delim,
+                                            std::pmr::memory_resource* resource );
+
 
 std::generator< std::smatch const& > iterateMatches( std::string const& line,
                                                      std::regex const& pattern );
@@ -19,3 +26,13 @@ using NumberCallback = std::function< void( long, std::size_t, std::size_t ) >;
 void iterateNumbers( std::string const& line,
                      NumberCallback const& callback,
                      bool withNegatives = true );
+
+
+// Lines of the text without their line breaks
+std::generator< std::string_view > splitLines( std::string_view text );
+
+// Splits the text into at most `count` chunks of similar size that only end after `delim`
+std::vector< std::string_view > splitChunks( std::string_view text, std::size_t count, char delim );
+
+// Splits the text into at most `count` chunks of similar size that only end at line breaks
+std::vector< std::string_view > splitLineChunks( std::string_view text, std::size_t count );
@@ -1,7 +1,12 @@
 #include <application.hpp>
+#include <cycle_utils.hpp>
+#include <flat_hash.hpp>
 #include <grid.hpp>
 #include <hash_utils.hpp>
 #include <math_utils.hpp>
+#include <memory_utils.hpp>
+#include <perf_utils.hpp>
 #include <std_generator.hpp>
 #include <stream_utils.hpp>
 #include <string_utils.hpp>
+#include <word_scanner.hpp>
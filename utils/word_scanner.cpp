@@ -0,0 +1,308 @@
+#include <word_scanner.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+
+namespace
+{
+    constexpr auto ONES = std::uint64_t{ 0x0101010101010101 };
+    constexpr auto HIGHS = std::uint64_t{ 0x8080808080808080 };
+
+    // High bit of every byte in [ '0', '9' ]. Bytes with the high bit set never qualify.
+    std::uint64_t findDigitBytes( std::uint64_t word )
+    {
+        auto const low = word & ~HIGHS;
+        auto const aboveMin = low + ONES * ( 0x80 - '0' );
+        auto const aboveMax = low + ONES * ( 0x80 - '9' - 1 );
+        return aboveMin & ~aboveMax & ~word & HIGHS;
+    }
+
+    bool isDigit( char c )
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    std::optional< int > findFirstDigit( std::string_view text )
+    {
+        auto i = 0uz;
+
+        for( ; i + 8 <= text.size(); i += 8 )
+        {
+            auto word = std::uint64_t{};
+            std::memcpy( &word, text.data() + i, 8 );
+
+            if( auto const digits = findDigitBytes( word ) )
+            {
+                return text[ i + std::countr_zero( digits ) / 8 ] - '0';
+            }
+        }
+
+        for( ; i < text.size(); ++i )
+        {
+            if( isDigit( text[ i ] ) )
+            {
+                return text[ i ] - '0';
+            }
+        }
+
+        return {};
+    }
+
+    std::optional< int > findLastDigit( std::string_view text )
+    {
+        auto end = text.size();
+
+        for( ; end >= 8; end -= 8 )
+        {
+            auto word = std::uint64_t{};
+            std::memcpy( &word, text.data() + end - 8, 8 );
+
+            if( auto const digits = findDigitBytes( word ) )
+            {
+                return text[ end - 8 + ( 63 - std::countl_zero( digits ) ) / 8 ] - '0';
+            }
+        }
+
+        for( ; end > 0; --end )
+        {
+            if( isDigit( text[ end - 1 ] ) )
+            {
+                return text[ end - 1 ] - '0';
+            }
+        }
+
+        return {};
+    }
+}
+
+
+WordScanner::WordScanner( ScannerWords const& words )
+    : m_forward{ Automaton::build( words ) }
+{
+    auto reversed = words;
+    for( auto& [ word, value ] : reversed )
+    {
+        std::reverse( std::begin( word ), std::end( word ) );
+    }
+    m_backward = Automaton::build( reversed );
+
+    auto const digitWords = getDigitWords();
+    m_hasDigitWords = std::ranges::all_of( digitWords,
+                                           [ & ]( auto const& digitWord )
+                                           {
+                                               return std::ranges::find( words, digitWord ) !=
+                                                      std::end( words );
+                                           } );
+
+    for( auto const& word : words )
+    {
+        if( std::ranges::find( digitWords, word ) == std::end( digitWords ) )
+        {
+            m_wordStarts[ static_cast< unsigned char >( word.first[ 0 ] ) ] = true;
+            m_hasOtherWords = true;
+        }
+    }
+}
+
+std::optional< int > WordScanner::findFirst( std::string_view text ) const
+{
+    if( isDigitsOnly( text ) )
+    {
+        return findFirstDigit( text );
+    }
+
+    return m_forward.findFirst( std::begin( text ), std::end( text ) );
+}
+
+std::optional< int > WordScanner::findLast( std::string_view text ) const
+{
+    if( isDigitsOnly( text ) )
+    {
+        return findLastDigit( text );
+    }
+
+    return m_backward.findFirst( std::rbegin( text ), std::rend( text ) );
+}
+
+ScannerMatches WordScanner::findFirstAndLast( std::string_view text ) const
+{
+    if( isDigitsOnly( text ) )
+    {
+        return { findFirstDigit( text ), findLastDigit( text ) };
+    }
+
+    return {
+        m_forward.findFirst( std::begin( text ), std::end( text ) ),
+        m_backward.findFirst( std::rbegin( text ), std::rend( text ) ),
+    };
+}
+
+bool WordScanner::isDigitsOnly( std::string_view text ) const
+{
+    if( !m_hasDigitWords || !m_hasOtherWords )
+    {
+        return m_hasDigitWords;
+    }
+
+    return std::ranges::none_of( text,
+                                 [ this ]( char c )
+                                 {
+                                     return m_wordStarts[ static_cast< unsigned char >( c ) ];
+                                 } );
+}
+
+WordScanner::Automaton WordScanner::Automaton::build( ScannerWords const& words )
+{
+    constexpr auto NONE = std::numeric_limits< std::uint16_t >::max();
+
+    auto automaton = Automaton{};
+    auto& transitions = automaton.transitions;
+
+    auto const addState = [ & ]()
+    {
+        if( transitions.size() == NONE )
+        {
+            throw std::runtime_error( "Too many scanner states" );
+        }
+
+        auto& state = transitions.emplace_back();
+        state.fill( NONE );
+        automaton.matchLengths.push_back( 0 );
+        automaton.matchValues.push_back( 0 );
+        return static_cast< std::uint16_t >( transitions.size() - 1 );
+    };
+
+    addState();
+
+    // Trie of all words
+    for( auto const& [ word, value ] : words )
+    {
+        if( word.empty() )
+        {
+            throw std::invalid_argument( "Scanner words must not be empty" );
+        }
+
+        auto state = std::uint16_t{ 0 };
+        for( auto const c : word )
+        {
+            auto const symbol = static_cast< unsigned char >( c );
+            if( transitions[ state ][ symbol ] == NONE )
+            {
+                auto const next = addState();
+                transitions[ state ][ symbol ] = next;
+            }
+            state = transitions[ state ][ symbol ];
+        }
+
+        automaton.matchLengths[ state ] = static_cast< std::uint16_t >( word.size() );
+        automaton.matchValues[ state ] = value;
+        automaton.maxLength = std::max( automaton.maxLength, word.size() );
+    }
+
+    // Complete the transitions along the failure links in breadth-first order
+    auto failure = std::vector< std::uint16_t >( transitions.size(), 0 );
+    auto open = std::queue< std::uint16_t >{};
+
+    for( auto& next : transitions[ 0 ] )
+    {
+        if( next == NONE )
+        {
+            next = 0;
+        }
+        else
+        {
+            open.push( next );
+        }
+    }
+
+    while( !open.empty() )
+    {
+        auto const state = open.front();
+        open.pop();
+
+        // The failure state is shallower, so its match is already final. Keep the longer one.
+        auto const fail = failure[ state ];
+        if( automaton.matchLengths[ state ] == 0 )
+        {
+            automaton.matchLengths[ state ] = automaton.matchLengths[ fail ];
+            automaton.matchValues[ state ] = automaton.matchValues[ fail ];
+        }
+
+        for( std::size_t symbol = 0; symbol < 256; ++symbol )
+        {
+            auto& next = transitions[ state ][ symbol ];
+            if( next == NONE )
+            {
+                next = transitions[ fail ][ symbol ];
+            }
+            else
+            {
+                failure[ next ] = transitions[ fail ][ symbol ];
+                open.push( next );
+            }
+        }
+    }
+
+    return automaton;
+}
+
+template < typename TIter >
+std::optional< int > WordScanner::Automaton::findFirst( TIter begin, TIter end ) const
+{
+    auto state = std::uint16_t{ 0 };
+    auto best = std::optional< int >{};
+    auto bestStart = std::size_t{ 0 };
+
+    auto pos = std::size_t{ 0 };
+    for( auto iter = begin; iter != end; ++iter, ++pos )
+    {
+        // A match starting earlier than the best one has to end within the longest word length
+        if( best && pos >= bestStart + maxLength )
+        {
+            break;
+        }
+
+        state = transitions[ state ][ static_cast< unsigned char >( *iter ) ];
+
+        if( auto const length = matchLengths[ state ] )
+        {
+            auto const start = pos + 1 - length;
+            if( !best || start < bestStart )
+            {
+                best = matchValues[ state ];
+                bestStart = start;
+            }
+        }
+    }
+
+    return best;
+}
+
+ScannerWords getDigitWords()
+{
+    auto words = ScannerWords{};
+    for( int digit = 0; digit < 10; ++digit )
+    {
+        words.emplace_back( std::string( 1, static_cast< char >( '0' + digit ) ), digit );
+    }
+    return words;
+}
+
+ScannerWords getSpelledDigitWords()
+{
+    auto words = getDigitWords();
+    auto const names = std::array{
+        "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine",
+    };
+
+    for( int digit = 0; digit < 10; ++digit )
+    {
+        words.emplace_back( names[ digit ], digit );
+    }
+    return words;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+using ScannerWords = std::vector< std::pair< std::string, int > >;
+
+struct ScannerMatches
+{
+    std::optional< int > first;
+    std::optional< int > last;
+};
+
+// Finds the first and the last occurrence of any word from a fixed dictionary in a text. Matches
+// may overlap. Each direction is an Aho-Corasick automaton with a complete transition table, so a
+// scan reads every byte once. If the dictionary contains the digits '0' to '9', texts without any
+// byte that starts one of the other words are searched for digits eight bytes at a time instead.
+// A dictionary of nothing but the digits always takes that path without looking at the text.
+class WordScanner
+{
+public:
+    explicit WordScanner( ScannerWords const& words );
+
+    // Value of the match that starts first
+    std::optional< int > findFirst( std::string_view text ) const;
+
+    // Value of the match that ends last
+    std::optional< int > findLast( std::string_view text ) const;
+
+    // Both of the above, deciding only once whether the digit search applies
+    ScannerMatches findFirstAndLast( std::string_view text ) const;
+
+private:
+    struct Automaton
+    {
+        std::vector< std::array< std::uint16_t, 256 > > transitions;
+
+        // Longest word ending in each state and its value (length 0 if none)
+        std::vector< std::uint16_t > matchLengths;
+        std::vector< int > matchValues;
+
+        std::size_t maxLength{ 0 };
+
+        static Automaton build( ScannerWords const& words );
+
+        template < typename TIter >
+        std::optional< int > findFirst( TIter begin, TIter end ) const;
+    };
+
+    // Whether only the digit words can match in the text
+    bool isDigitsOnly( std::string_view text ) const;
+
+    Automaton m_forward;
+    Automaton m_backward;
+    bool m_hasDigitWords;
+    bool m_hasOtherWords{ false };
+
+    // First bytes of all words other than the digits
+    std::array< bool, 256 > m_wordStarts{};
+};
+
+// Words and values of the digits '0' to '9'
+ScannerWords getDigitWords();
+
+// Digits '0' to '9' as well as their names "zero" to "nine"
+ScannerWords getSpelledDigitWords();